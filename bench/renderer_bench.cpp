@@ -0,0 +1,474 @@
+#include "core/framebuffer.h"
+#include "core/hdr_buffer.h"
+#include "image/color.h"
+#include "image/compressed_texture.h"
+#include "image/primitives.h"
+#include "image/tgaimage.h"
+#include "image/upscale.h"
+#include "math/mat4.h"
+#include "math/vec3.h"
+#include "math/vec3x8.h"
+#include "math/vec4.h"
+#include "raytrace/bvh.h"
+#include "raytrace/ray_caster.h"
+#include "rendering/oit_buffer.h"
+#include "scene/mesh.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Micro-benchmarks for the renderer's hot paths. No window, no network.
+//
+// Every benchmark is calibrated so one sample takes about a millisecond,
+// warmed up, then sampled repeatedly. Results (per-iteration median and p99)
+// are printed as JSON and can be compared against a checked-in baseline:
+//
+//   renderer_bench --baseline bench/baseline.json --tolerance 0.25
+//
+// exits with 1 if any benchmark's median got slower than baseline * (1 + tolerance).
+// Baselines are machine specific - regenerate with --json on the reference box.
+
+namespace {
+    // Keep the optimizer from deleting benchmark work
+    template <typename T>
+    void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    struct BenchResult {
+        std::string name;
+        double medianNs = 0.0;
+        double p99Ns = 0.0;
+        long long iterations = 0;
+        int samples = 0;
+    };
+
+    struct BenchOptions {
+        int samples = 30;
+        int warmupSamples = 3;
+        double targetSampleNs = 1e6;
+        std::string filter;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    double runBatch(const std::function<void()>& fn, long long iterations) {
+        const auto start = Clock::now();
+        for (long long i = 0; i < iterations; i++) {
+            fn();
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    double percentile(std::vector<double> values, double p) {
+        std::sort(values.begin(), values.end());
+        const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+        return values[index];
+    }
+
+    BenchResult runBenchmark(const std::string& name, const std::function<void()>& fn, const BenchOptions& options) {
+        // Calibrate: grow the batch until one sample takes targetSampleNs
+        long long iterations = 1;
+        while (iterations < (1LL << 30)) {
+            const double ns = runBatch(fn, iterations);
+            if (ns >= options.targetSampleNs) break;
+            iterations *= (ns < options.targetSampleNs / 16) ? 8 : 2;
+        }
+
+        for (int i = 0; i < options.warmupSamples; i++) {
+            runBatch(fn, iterations);
+        }
+
+        std::vector<double> perIteration;
+        perIteration.reserve(options.samples);
+        for (int i = 0; i < options.samples; i++) {
+            perIteration.push_back(runBatch(fn, iterations) / iterations);
+        }
+
+        BenchResult result;
+        result.name = name;
+        result.medianNs = percentile(perIteration, 0.5);
+        result.p99Ns = percentile(perIteration, 0.99);
+        result.iterations = iterations;
+        result.samples = options.samples;
+        return result;
+    }
+
+    std::string toJson(const std::vector<BenchResult>& results) {
+        std::ostringstream out;
+        out << "{\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            char line[256];
+            std::snprintf(line, sizeof(line),
+                          "    {\"name\": \"%s\", \"median_ns\": %.3f, \"p99_ns\": %.3f, \"iterations\": %lld, \"samples\": %d}%s\n",
+                          r.name.c_str(), r.medianNs, r.p99Ns, r.iterations, r.samples,
+                          i + 1 < results.size() ? "," : "");
+            out << line;
+        }
+        out << "  ]\n}\n";
+        return out.str();
+    }
+
+    // Reads back the format written by toJson(): name -> median_ns
+    bool loadBaseline(const std::string& path, std::map<std::string, double>& medians) {
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            std::cerr << "can't open baseline " << path << "\n";
+            return false;
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        const std::string text = buffer.str();
+
+        size_t pos = 0;
+        while ((pos = text.find("\"name\"", pos)) != std::string::npos) {
+            const size_t open = text.find('"', text.find(':', pos) + 1);
+            const size_t close = text.find('"', open + 1);
+            const size_t medianKey = text.find("\"median_ns\"", close);
+            if (open == std::string::npos || close == std::string::npos || medianKey == std::string::npos) {
+                break;
+            }
+            const std::string name = text.substr(open + 1, close - open - 1);
+            medians[name] = std::strtod(text.c_str() + text.find(':', medianKey) + 1, nullptr);
+            pos = medianKey;
+        }
+        return !medians.empty();
+    }
+
+    // Silences TGAImage's progress output while benchmarking reads
+    struct ScopedCerrMute {
+        std::ostringstream sink;
+        std::streambuf* previous;
+        ScopedCerrMute() : previous(std::cerr.rdbuf(sink.rdbuf())) {}
+        ~ScopedCerrMute() { std::cerr.rdbuf(previous); }
+    };
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    std::string jsonPath;
+    std::string baselinePath;
+    double tolerance = 0.25;
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--samples") && hasValue) {
+            options.samples = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--filter") && hasValue) {
+            options.filter = argv[++i];
+        } else if (!std::strcmp(argv[i], "--json") && hasValue) {
+            jsonPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--baseline") && hasValue) {
+            baselinePath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--tolerance") && hasValue) {
+            tolerance = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Usage: renderer_bench [--samples N] [--filter substring] [--json out.json]\n"
+                         "                      [--baseline baseline.json] [--tolerance 0.25]\n";
+            return 2;
+        }
+    }
+
+    // Shared inputs
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<vec3> vectors(1024);
+    for (vec3& v : vectors) {
+        v = vec3(unit(rng), unit(rng), unit(rng));
+    }
+    const mat4 modelView = mat4::lookAt(vec3(3, 2, 5), vec3(0, 0, 0), vec3(0, 1, 0)) *
+                           mat4::rotate(0.3f, vec3(1, 1, 0)) * mat4::scale(1.5f);
+    const mat4 projection = mat4::perspective(1.0f, 4.0f / 3.0f, 0.1f, 100.0f);
+    std::vector<color> colors(1024);
+    for (color& c : colors) {
+        c = color(unit(rng) + 0.5f, unit(rng) + 0.5f, unit(rng) + 0.5f, 1.0f);
+    }
+
+    Framebuffer framebuffer(800, 600);
+    Framebuffer lowRes(560, 420);
+    FillWithGradient(lowRes);
+    LinearArena upscaleScratch;
+    HDRBuffer hdr(800, 600);
+    for (int y = 0; y < 600; y++) {
+        for (int x = 0; x < 800; x++) {
+            hdr.setPixel(x, y, color(x / 200.0f, y / 150.0f, 0.5f));
+        }
+    }
+
+    // Overlapping translucent triangles for the OIT path
+    OITBuffer oit(800, 600);
+    std::vector<float> oitVertices(256 * 9);
+    for (size_t i = 0; i < 256; i++) {
+        const float cx = 400.0f + 300.0f * unit(rng), cy = 300.0f + 200.0f * unit(rng);
+        for (int v = 0; v < 3; v++) {
+            oitVertices[i * 9 + v] = cx + 60.0f * unit(rng);
+            oitVertices[i * 9 + 3 + v] = cy + 60.0f * unit(rng);
+            oitVertices[i * 9 + 6 + v] = unit(rng);
+        }
+    }
+
+    // Ground plane plus a field of boxes for the ray caster
+    Mesh boxField;
+    boxField.appendQuad(mat4::translate(0.0f, -1.0f, 0.0f) * mat4::scale(20.0f), color(0.7f, 0.7f, 0.7f));
+    for (int i = 0; i < 300; i++) {
+        const mat4 placement = mat4::translate(10.0f * unit(rng), 2.0f * unit(rng), 10.0f * unit(rng)) *
+                               mat4::rotateY(3.0f * unit(rng)) * mat4::scale(0.45f + 0.25f * unit(rng));
+        boxField.appendBox(placement, color(unit(rng) + 0.5f, 0.6f, unit(rng) + 0.5f));
+    }
+    BVH bvh;
+    bvh.build(boxField);
+    RayCaster rayCaster(bvh);
+    RayCastSettings rayCastSettings;
+    rayCastSettings.aoSamples = 2;
+    Framebuffer rayCastTarget(200, 150);
+    const mat4 rayCastView = mat4::lookAt(vec3(0.0f, 6.0f, 14.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+    const mat4 rayCastProjection = mat4::perspective(0.9f, 4.0f / 3.0f, 0.5f, 100.0f);
+
+    // TGA inputs: a smooth image (RLE friendly) written both ways
+    TGAImage image(512, 512, TGAImage::RGBA);
+    for (int y = 0; y < 512; y++) {
+        for (int x = 0; x < 512; x++) {
+            TGAColor c;
+            c[0] = static_cast<uint8_t>(x / 4);
+            c[1] = static_cast<uint8_t>(y / 4);
+            c[2] = 128;
+            c[3] = 255;
+            image.set(x, y, c);
+        }
+    }
+    CompressedTexture compressed;
+    compressed.encode(image, BlockFormat::BC1);
+    TextureSampler sampler(compressed);
+
+    const std::string rlePath = "renderer_bench_rle.tga";
+    const std::string rawPath = "renderer_bench_raw.tga";
+    image.write_tga_file(rlePath, false, true);
+    image.write_tga_file(rawPath, false, false);
+
+    std::vector<std::pair<std::string, std::function<void()>>> benchmarks = {
+        { "vec3_dot_cross_x1024", [&] {
+            vec3 acc;
+            for (size_t i = 0; i + 1 < vectors.size(); i++) {
+                acc += vectors[i].cross(vectors[i + 1]) * vectors[i].dot(vectors[i + 1]);
+            }
+            doNotOptimize(acc);
+        }},
+        { "vec3_normalized_x1024", [&] {
+            vec3 acc;
+            for (const vec3& v : vectors) {
+                acc += v.normalized();
+            }
+            doNotOptimize(acc);
+        }},
+        { "mat4_multiply", [&] {
+            mat4 m = projection * modelView;
+            doNotOptimize(m);
+        }},
+        { "mat4_inverse", [&] {
+            mat4 m = modelView.inverse();
+            doNotOptimize(m);
+        }},
+        { "mat4_transform_x1024", [&] {
+            const mat4 mvp = projection * modelView;
+            vec3 acc;
+            for (const vec3& v : vectors) {
+                acc += mvp * v;
+            }
+            doNotOptimize(acc);
+        }},
+        { "vec3x8_normalized_x1024", [&] {
+            vec3x8 acc;
+            for (size_t i = 0; i < vectors.size(); i += 8) {
+                acc = acc + vec3x8::load(&vectors[i]).normalized();
+            }
+            doNotOptimize(acc);
+        }},
+        { "vec3x8_transform_x1024", [&] {
+            const mat4 mvp = projection * modelView;
+            vec3x8 acc;
+            for (size_t i = 0; i < vectors.size(); i += 8) {
+                acc = acc + vec3x8::load(&vectors[i]).transformPoint(mvp);
+            }
+            doNotOptimize(acc);
+        }},
+        { "mat4_vec4_transform_x1024", [&] {
+            const mat4 mvp = projection * modelView;
+            vec4 acc;
+            for (const vec3& v : vectors) {
+                acc += mvp * vec4(v, 1.0f);
+            }
+            doNotOptimize(acc);
+        }},
+        { "color_toUint32_x1024", [&] {
+            uint32_t acc = 0;
+            for (const color& c : colors) {
+                acc ^= c.toUint32();
+            }
+            doNotOptimize(acc);
+        }},
+        { "framebuffer_clear_800x600", [&] {
+            framebuffer.clear(0xFF102030);
+            doNotOptimize(framebuffer);
+        }},
+        { "framebuffer_setPixel_800x600", [&] {
+            for (int y = 0; y < 600; y++) {
+                for (int x = 0; x < 800; x++) {
+                    framebuffer.setPixel(x, y, 0xFF000000u | uint32_t(x ^ y));
+                }
+            }
+            doNotOptimize(framebuffer);
+        }},
+        { "draw_line_x64", [&] {
+            for (int i = 0; i < 64; i++) {
+                DrawLine(i * 12, 0, 799 - i * 12, 599, color::red(), framebuffer);
+            }
+            doNotOptimize(framebuffer);
+        }},
+        { "draw_triangle_outline_x64", [&] {
+            for (int i = 0; i < 64; i++) {
+                DrawTriangle(400, i, 700 - i, 550, 100 + i, 500, color::cyan(), framebuffer);
+            }
+            doNotOptimize(framebuffer);
+        }},
+        { "fill_triangle_400x300", [&] {
+            FillTriangle(400.25f, 100.5f, 700.75f, 400.0f, 100.0f, 400.5f, color::green(), framebuffer);
+            doNotOptimize(framebuffer);
+        }},
+        { "fill_triangle_shaded_400x300", [&] {
+            FillTriangle(400.25f, 100.5f, 700.75f, 400.0f, 100.0f, 400.5f,
+                         color::red(), color::green(), color::blue(), framebuffer);
+            doNotOptimize(framebuffer);
+        }},
+        { "fill_with_gradient_800x600", [&] {
+            FillWithGradient(framebuffer);
+            doNotOptimize(framebuffer);
+        }},
+        { "upscale_bilinear_560x420_to_800x600", [&] {
+            upscaleScratch.reset();
+            UpscaleBilinear(lowRes, framebuffer, nullptr, &upscaleScratch);
+            doNotOptimize(framebuffer);
+        }},
+        { "oit_256_triangles_800x600", [&] {
+            const color translucent[3] = { color(1, 0, 0, 0.5f), color(0, 1, 0, 0.5f), color(0, 0, 1, 0.5f) };
+            oit.reset();
+            for (size_t i = 0; i < 256; i++) {
+                const float* v = &oitVertices[i * 9];
+                oit.insertTriangle(v, v + 3, v + 6, translucent);
+            }
+            oit.resolve(framebuffer);
+            doNotOptimize(framebuffer);
+        }},
+        { "tonemap_aces_800x600", [&] {
+            ToneMap(hdr, framebuffer);
+            doNotOptimize(framebuffer);
+        }},
+        { "bc1_sample_bilinear_x1024", [&] {
+            // Minified diagonal walk over the 512x512 texture
+            uint32_t sum = 0;
+            for (int i = 0; i < 1024; i++) {
+                sum += sampler.sampleBilinear(i / 1024.0f, (i * 3 % 1024) / 1024.0f);
+            }
+            doNotOptimize(sum);
+        }},
+        { "bvh_build_box_field", [&] {
+            BVH built;
+            built.build(boxField);
+            doNotOptimize(built);
+        }},
+        { "bvh_refit_box_field", [&] {
+            bvh.refit();
+            doNotOptimize(bvh);
+        }},
+        { "raycast_shadows_ao2_200x150", [&] {
+            rayCaster.render(rayCastTarget, rayCastView, rayCastProjection, rayCastSettings);
+            doNotOptimize(rayCastTarget);
+        }},
+        { "tga_write_rle_512", [&] {
+            image.write_tga_file(rlePath, false, true);
+        }},
+        { "tga_write_raw_512", [&] {
+            image.write_tga_file(rawPath, false, false);
+        }},
+        { "tga_read_rle_512", [&] {
+            ScopedCerrMute mute;
+            TGAImage loaded;
+            loaded.read_tga_file(rlePath);
+            doNotOptimize(loaded);
+        }},
+        { "tga_read_raw_512", [&] {
+            ScopedCerrMute mute;
+            TGAImage loaded;
+            loaded.read_tga_file(rawPath);
+            doNotOptimize(loaded);
+        }},
+    };
+
+    std::vector<BenchResult> results;
+    for (const auto& [name, fn] : benchmarks) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        results.push_back(runBenchmark(name, fn, options));
+        const BenchResult& r = results.back();
+        std::fprintf(stderr, "%-32s median %12.1f ns   p99 %12.1f ns\n", r.name.c_str(), r.medianNs, r.p99Ns);
+    }
+
+    std::remove(rlePath.c_str());
+    std::remove(rawPath.c_str());
+
+    const std::string json = toJson(results);
+    if (jsonPath.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream out(jsonPath);
+        out << json;
+        if (!out.good()) {
+            std::cerr << "can't write " << jsonPath << "\n";
+            return 2;
+        }
+    }
+
+    if (baselinePath.empty()) {
+        return 0;
+    }
+
+    std::map<std::string, double> baseline;
+    if (!loadBaseline(baselinePath, baseline)) {
+        return 2;
+    }
+
+    int regressions = 0;
+    for (const BenchResult& r : results) {
+        auto it = baseline.find(r.name);
+        if (it == baseline.end()) {
+            std::fprintf(stderr, "%-32s no baseline\n", r.name.c_str());
+            continue;
+        }
+        const double ratio = r.medianNs / it->second;
+        const bool regressed = ratio > 1.0 + tolerance;
+        regressions += regressed ? 1 : 0;
+        std::fprintf(stderr, "%-32s %6.2fx baseline%s\n", r.name.c_str(), ratio, regressed ? "  REGRESSION" : "");
+    }
+
+    if (regressions > 0) {
+        std::fprintf(stderr, "%d benchmark(s) slower than baseline by more than %.0f%%\n", regressions, tolerance * 100.0);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "frame_arena.h"
+#include <algorithm>
+
+namespace {
+    size_t alignUp(uintptr_t value, size_t alignment) {
+        return static_cast<size_t>((value + alignment - 1) & ~(uintptr_t(alignment) - 1));
+    }
+
+    // Round block sizes up so repeated growth settles quickly
+    size_t roundCapacity(size_t bytes) {
+        constexpr size_t granularity = 64 * 1024;
+        return (bytes + granularity - 1) / granularity * granularity;
+    }
+}
+
+LinearArena::LinearArena(size_t capacity) {
+    if (capacity > 0) {
+        blockSize = capacity;
+        block.reset(new std::byte[blockSize]);
+    }
+}
+
+void* LinearArena::allocate(size_t bytes, size_t alignment) {
+    allocationCount++;
+    if (block) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+        size_t start = alignUp(base + offset, alignment) - base;
+        if (start + bytes <= blockSize) {
+            used += (start + bytes) - offset;
+            offset = start + bytes;
+            return block.get() + start;
+        }
+    }
+    return allocateOverflow(bytes, alignment);
+}
+
+void* LinearArena::allocateOverflow(size_t bytes, size_t alignment) {
+    if (!overflowBlocks.empty()) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(overflowBlocks.back().get());
+        size_t start = alignUp(base + overflowOffset, alignment) - base;
+        if (start + bytes <= overflowSize) {
+            overflowUsed += (start + bytes) - overflowOffset;
+            overflowOffset = start + bytes;
+            return overflowBlocks.back().get() + start;
+        }
+    }
+
+    // New overflow block: at least as big as the primary one so a frame that
+    // overflows once does not degrade into one heap allocation per request
+    overflowSize = std::max(roundCapacity(bytes + alignment), std::max(blockSize, size_t(64 * 1024)));
+    overflowBlocks.emplace_back(new std::byte[overflowSize]);
+    uintptr_t base = reinterpret_cast<uintptr_t>(overflowBlocks.back().get());
+    size_t start = alignUp(base, alignment) - base;
+    overflowOffset = start + bytes;
+    overflowUsed += overflowOffset;
+    return overflowBlocks.back().get() + start;
+}
+
+void LinearArena::reset() {
+    const size_t frameBytes = used + overflowUsed;
+    highWater = std::max(highWater, frameBytes);
+
+    // Grow so the next frame of the same size fits in one block
+    if (!overflowBlocks.empty()) {
+        overflowBlocks.clear();
+        blockSize = roundCapacity(highWater);
+        block.reset(new std::byte[blockSize]);
+    }
+
+    offset = 0;
+    used = 0;
+    overflowOffset = 0;
+    overflowSize = 0;
+    overflowUsed = 0;
+    allocationCount = 0;
+}
+
+ArenaStats LinearArena::stats() const {
+    ArenaStats s;
+    s.bytesUsed = used + overflowUsed;
+    s.highWaterMark = std::max(highWater, s.bytesUsed);
+    s.capacity = blockSize;
+    s.overflowBytes = overflowUsed;
+    s.allocations = allocationCount;
+    return s;
+}
+
+FrameArena::FrameArena(int threadCount, size_t bytesPerThread) {
+    arenas.reserve(std::max(threadCount, 1));
+    for (int i = 0; i < std::max(threadCount, 1); i++) {
+        arenas.push_back(std::make_unique<LinearArena>(bytesPerThread));
+    }
+}
+
+void FrameArena::reset() {
+    for (auto& arena : arenas) {
+        arena->reset();
+    }
+}
+
+ArenaStats FrameArena::stats() const {
+    ArenaStats total;
+    for (const auto& arena : arenas) {
+        ArenaStats s = arena->stats();
+        total.bytesUsed += s.bytesUsed;
+        total.highWaterMark += s.highWaterMark;
+        total.capacity += s.capacity;
+        total.overflowBytes += s.overflowBytes;
+        total.allocations += s.allocations;
+    }
+    return total;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Typed view over memory handed out by a LinearArena.
+// Does not own anything - the memory is recycled when the arena resets.
+template <typename T>
+struct ArenaSpan {
+    T* ptr = nullptr;
+    size_t count = 0;
+
+    T* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    T* begin() const { return ptr; }
+    T* end() const { return ptr + count; }
+
+    T& operator[](size_t i) const { return ptr[i]; }
+};
+
+// Allocation statistics for one arena (or the sum over all thread arenas)
+struct ArenaStats {
+    size_t bytesUsed = 0;        // Bytes handed out since the last reset
+    size_t highWaterMark = 0;    // Largest bytesUsed seen at any reset
+    size_t capacity = 0;         // Size of the primary block(s)
+    size_t overflowBytes = 0;    // Bytes that did not fit the primary block this frame
+    uint32_t allocations = 0;    // Number of allocate() calls since the last reset
+};
+
+// Linear (bump) allocator for transient data.
+// Allocation is a pointer bump; there is no per-allocation free. Everything
+// handed out is released at once by reset(). Objects placed here are never
+// destroyed, so only trivially destructible types are allowed.
+//
+// If a frame asks for more than the primary block holds, the request is served
+// from an overflow block so nothing fails mid-frame. On the next reset the
+// primary block grows to the high-water mark, so steady-state frames run out
+// of a single block with no heap traffic at all.
+//
+// NOT thread-safe: each worker thread gets its own arena (see FrameArena).
+// Cache-line aligned so arenas of different threads never share a line.
+class alignas(64) LinearArena {
+public:
+    explicit LinearArena(size_t capacity = 0);
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+    LinearArena(LinearArena&&) = default;
+    LinearArena& operator=(LinearArena&&) = default;
+
+    // Raw allocation. Alignment must be a power of two.
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    // Allocate a single object / an array of objects.
+    // Without constructor arguments, trivially constructible types are left
+    // uninitialized (like malloc); everything else is constructed as given.
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "LinearArena never runs destructors");
+        void* p = allocate(sizeof(T), alignof(T));
+        if constexpr (sizeof...(Args) == 0 && std::is_trivially_default_constructible_v<T>) {
+            return new (p) T;
+        } else {
+            return new (p) T(std::forward<Args>(args)...);
+        }
+    }
+
+    template <typename T>
+    ArenaSpan<T> allocSpan(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "LinearArena never runs destructors");
+        if (count == 0) return {};
+        T* p = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        if constexpr (!std::is_trivially_default_constructible_v<T>) {
+            for (size_t i = 0; i < count; i++) new (p + i) T();
+        }
+        return {p, count};
+    }
+
+    // Copy existing elements into the arena
+    template <typename T>
+    ArenaSpan<T> copySpan(const T* src, size_t count) {
+        ArenaSpan<T> span = allocSpan<T>(count);
+        for (size_t i = 0; i < count; i++) span.ptr[i] = src[i];
+        return span;
+    }
+
+    // Release everything allocated since the last reset.
+    // Grows the primary block if the previous frame overflowed.
+    void reset();
+
+    ArenaStats stats() const;
+    size_t bytesUsed() const { return used + overflowUsed; }
+
+private:
+    void* allocateOverflow(size_t bytes, size_t alignment);
+
+    std::unique_ptr<std::byte[]> block;
+    size_t blockSize = 0;
+    size_t offset = 0;
+
+    // Overflow blocks live only until the next reset
+    std::vector<std::unique_ptr<std::byte[]>> overflowBlocks;
+    size_t overflowOffset = 0;
+    size_t overflowSize = 0;
+
+    size_t used = 0;
+    size_t overflowUsed = 0;
+    size_t highWater = 0;
+    uint32_t allocationCount = 0;
+};
+
+// Per-frame allocator: one LinearArena per worker thread.
+// Threads allocate only from their own slot, so there is no locking and no
+// shared cache lines on the allocation path. Call reset() once per frame,
+// after all workers are done with the frame's data.
+class FrameArena {
+public:
+    FrameArena(int threadCount, size_t bytesPerThread);
+
+    int getThreadCount() const { return static_cast<int>(arenas.size()); }
+
+    // Arena owned by the given worker (0 = main thread)
+    LinearArena& local(int threadIndex) { return *arenas[threadIndex]; }
+
+    template <typename T>
+    ArenaSpan<T> allocSpan(int threadIndex, size_t count) {
+        return local(threadIndex).allocSpan<T>(count);
+    }
+
+    // End of frame: recycle every thread's memory
+    void reset();
+
+    // Sum over all threads (highWaterMark is the sum of per-thread peaks)
+    ArenaStats stats() const;
+    ArenaStats stats(int threadIndex) const { return arenas[threadIndex]->stats(); }
+
+private:
+    // Each arena is heap-allocated separately; LinearArena's alignas(64)
+    // keeps the bookkeeping of two threads off a shared cache line.
+    std::vector<std::unique_ptr<LinearArena>> arenas;
+};
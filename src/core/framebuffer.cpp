@@ -1,9 +1,59 @@
 #include "framebuffer.h"
 #include <algorithm>
+#include <utility>
 
 Framebuffer::Framebuffer(int width, int height)
     : width(width), height(height) {
-    pixels.resize(width * height, 0xFF000000);  // Default: black
+    storage.resize(width * height, 0xFF000000);  // Default: black
+    pixels = storage.data();
+}
+
+Framebuffer::Framebuffer(int width, int height, uint32_t* externalPixels)
+    : width(width), height(height), pixels(externalPixels), external(true) {
+}
+
+Framebuffer::Framebuffer(const Framebuffer& other)
+    : width(other.width), height(other.height), storage(other.storage), external(other.external) {
+    // Copies of an external framebuffer alias the same memory
+    pixels = external ? other.pixels : storage.data();
+}
+
+Framebuffer& Framebuffer::operator=(const Framebuffer& other) {
+    if (this != &other) {
+        width = other.width;
+        height = other.height;
+        storage = other.storage;
+        external = other.external;
+        pixels = external ? other.pixels : storage.data();
+    }
+    return *this;
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept
+    : width(other.width), height(other.height), storage(std::move(other.storage)), pixels(other.pixels),
+      external(other.external) {
+    // Moving a vector keeps its buffer, so pixels stays valid for owned memory
+    other.width = 0;
+    other.height = 0;
+    other.storage.clear();
+    other.pixels = nullptr;
+    other.external = false;
+}
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept {
+    if (this != &other) {
+        width = other.width;
+        height = other.height;
+        storage = std::move(other.storage);
+        pixels = other.pixels;
+        external = other.external;
+        other.width = 0;
+        other.height = 0;
+        other.storage.clear();
+        other.pixels = nullptr;
+        other.external = false;
+    }
+    return *this;
 }
 
 void Framebuffer::setPixel(int x, int y, uint32_t color) {
@@ -20,7 +70,22 @@ uint32_t Framebuffer::getPixel(int x, int y) const {
 }
 
 void Framebuffer::clear(uint32_t color) {
-    std::fill(pixels.begin(), pixels.end(), color);
+    std::fill(pixels, pixels + width * height, color);
+}
+
+bool Framebuffer::resize(int newWidth, int newHeight) {
+    if (newWidth == width && newHeight == height) {
+        return true;
+    }
+    if (external) {
+        return false;
+    }
+    width = newWidth;
+    height = newHeight;
+    // vector::resize never gives memory back, so shrinking is free
+    storage.resize(size_t(width) * height, 0xFF000000);
+    pixels = storage.data();
+    return true;
 }
 
 bool Framebuffer::isInBounds(int x, int y) const {
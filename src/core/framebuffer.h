@@ -9,23 +9,44 @@ class Framebuffer {
 public:
     Framebuffer(int width, int height);
 
+    // Wrap pixel memory owned by someone else (e.g. a shared memory region).
+    // The memory must hold width * height pixels and outlive the framebuffer.
+    Framebuffer(int width, int height, uint32_t* externalPixels);
+
+    Framebuffer(const Framebuffer& other);
+    Framebuffer& operator=(const Framebuffer& other);
+    // Moved-from framebuffers are left empty (0x0, not external)
+    Framebuffer(Framebuffer&& other) noexcept;
+    Framebuffer& operator=(Framebuffer&& other) noexcept;
+
     // Basic pixel operations
     void setPixel(int x, int y, uint32_t color);
     uint32_t getPixel(int x, int y) const;
     void clear(uint32_t color = 0xFF000000);
 
+    // Change the dimensions, keeping the allocation when shrinking so that
+    // per-frame resolution changes do not hit the heap. Pixel contents are
+    // unspecified afterwards. External framebuffers can't be resized: they
+    // keep their size and this returns false (unless the size is unchanged).
+    bool resize(int newWidth, int newHeight);
+
     // Direct access to pixel data (for SDL)
-    uint32_t* data() { return pixels.data(); }
-    const uint32_t* data() const { return pixels.data(); }
+    uint32_t* data() { return pixels; }
+    const uint32_t* data() const { return pixels; }
 
     // Dimensions
     int getWidth() const { return width; }
     int getHeight() const { return height; }
 
+    // True if the pixels live in memory this object does not own
+    bool isExternal() const { return external; }
+
 private:
     int width;
     int height;
-    std::vector<uint32_t> pixels;  // ARGB8888 format
+    std::vector<uint32_t> storage;  // ARGB8888 format, empty when external
+    uint32_t* pixels;               // storage.data() or the external memory
+    bool external = false;          // pixels is someone else's memory
 
     bool isInBounds(int x, int y) const;
 };
@@ -40,3 +61,16 @@ inline uint8_t getRed(uint32_t color)   { return (color >> 16) & 0xFF; }
 inline uint8_t getGreen(uint32_t color) { return (color >> 8) & 0xFF; }
 inline uint8_t getBlue(uint32_t color)  { return color & 0xFF; }
 inline uint8_t getAlpha(uint32_t color) { return (color >> 24) & 0xFF; }
+
+// Alpha-blend src over dst (both ARGB8888, straight alpha)
+inline uint32_t blendOver(uint32_t dst, uint32_t src) {
+    const uint32_t a = src >> 24;
+    if (a == 255) return src;
+    if (a == 0) return dst;
+    const uint32_t ia = 255 - a;
+    const uint32_t r = (getRed(src) * a + getRed(dst) * ia + 127) / 255;
+    const uint32_t g = (getGreen(src) * a + getGreen(dst) * ia + 127) / 255;
+    const uint32_t b = (getBlue(src) * a + getBlue(dst) * ia + 127) / 255;
+    const uint32_t outA = a + (getAlpha(dst) * ia + 127) / 255;
+    return (outA << 24) | (r << 16) | (g << 8) | b;
+}
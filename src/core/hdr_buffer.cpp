@@ -0,0 +1,295 @@
+#include "hdr_buffer.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HDR_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // Rows per parallel job
+    constexpr int STRIP_ROWS = 32;
+
+    constexpr int ENCODE_TABLE_SIZE = 4096;
+
+    struct SRGBTables {
+        float toLinear[256];
+        uint8_t fromLinear[ENCODE_TABLE_SIZE];
+
+        SRGBTables() {
+            for (int i = 0; i < 256; i++) {
+                const double s = i / 255.0;
+                toLinear[i] = static_cast<float>(s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4));
+            }
+            for (int i = 0; i < ENCODE_TABLE_SIZE; i++) {
+                const double l = i / double(ENCODE_TABLE_SIZE - 1);
+                const double s = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+                fromLinear[i] = static_cast<uint8_t>(std::clamp(s * 255.0 + 0.5, 0.0, 255.0));
+            }
+        }
+    };
+
+    // Built once, on first use
+    const SRGBTables& tables() {
+        static const SRGBTables instance;
+        return instance;
+    }
+
+    inline uint32_t floatBits(float f) {
+        uint32_t u;
+        std::memcpy(&u, &f, 4);
+        return u;
+    }
+
+    inline float bitsFloat(uint32_t u) {
+        float f;
+        std::memcpy(&f, &u, 4);
+        return f;
+    }
+
+    // Clamps written so NaN behaves like the SSE path (_mm_max_ps/_mm_min_ps
+    // return their second operand on NaN): NaN floors to 0, ceils to 1
+    inline float floorZero(float v) { return v > 0.0f ? v : 0.0f; }
+    inline float ceilOne(float v) { return v < 1.0f ? v : 1.0f; }
+
+    inline uint8_t encodeAlpha(float a) {
+        return static_cast<uint8_t>(ceilOne(floorZero(a)) * 255.0f + 0.5f);
+    }
+
+    // Scalar tone curve, for the non-SSE build and row tails
+    inline float toneCurve(float v, ToneMapOperator op) {
+        switch (op) {
+            case ToneMapOperator::Reinhard: return v / (1.0f + v);
+            case ToneMapOperator::ACES:     return (v * (2.51f * v + 0.03f)) / (v * (2.43f * v + 0.59f) + 0.14f);
+            default:                        return v;
+        }
+    }
+
+    inline uint32_t encodePixelScalar(const float rgba[4], const ToneMapSettings& settings, const uint8_t* lut) {
+        uint32_t channels[3];
+        for (int c = 0; c < 3; c++) {
+            // Inf turns into NaN in the curve (Inf / Inf) and leaves as 1
+            const float v = ceilOne(toneCurve(floorZero(rgba[c] * settings.exposure), settings.op));
+            channels[c] = lut[static_cast<int>(v * (ENCODE_TABLE_SIZE - 1) + 0.5f)];
+        }
+        return (uint32_t(encodeAlpha(rgba[3])) << 24) | (channels[0] << 16) | (channels[1] << 8) | channels[2];
+    }
+
+#ifdef HDR_USE_SSE2
+    // 4 halves -> 4 floats. Normals and denormals come out of one multiply
+    // by 2^112 (rebiasing the exponent); Inf/NaN get their exponent forced.
+    inline __m128 halfToFloat4(const uint16_t* h) {
+        const __m128i halves = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(h)),
+                                                  _mm_setzero_si128());
+        const __m128i expMant = _mm_and_si128(halves, _mm_set1_epi32(0x7FFF));
+        const __m128i sign = _mm_slli_epi32(_mm_xor_si128(halves, expMant), 16);
+        const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMant, 13)),
+                                         _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+        const __m128i infNan = _mm_and_si128(_mm_cmpgt_epi32(expMant, _mm_set1_epi32(0x7BFF)),
+                                             _mm_set1_epi32(255 << 23));
+        return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infNan)));
+    }
+
+    // Exposure + curve + clamp on 4 values, scaled to encode table indices.
+    // max(v, 0) comes first: it also turns NaN into 0.
+    inline __m128i encodeIndices(__m128 v, const ToneMapSettings& settings) {
+        v = _mm_max_ps(_mm_mul_ps(v, _mm_set1_ps(settings.exposure)), _mm_setzero_ps());
+        if (settings.op == ToneMapOperator::Reinhard) {
+            v = _mm_div_ps(v, _mm_add_ps(v, _mm_set1_ps(1.0f)));
+        } else if (settings.op == ToneMapOperator::ACES) {
+            const __m128 numerator = _mm_mul_ps(v, _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(2.51f)), _mm_set1_ps(0.03f)));
+            const __m128 denominator = _mm_add_ps(_mm_mul_ps(v, _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(2.43f)),
+                                                                           _mm_set1_ps(0.59f))),
+                                                  _mm_set1_ps(0.14f));
+            v = _mm_div_ps(numerator, denominator);
+        }
+        v = _mm_min_ps(v, _mm_set1_ps(1.0f));
+        return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(ENCODE_TABLE_SIZE - 1.0f)), _mm_set1_ps(0.5f)));
+    }
+
+    inline __m128i encodeAlpha4(__m128 a) {
+        a = _mm_min_ps(_mm_max_ps(a, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(a, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+    }
+
+    // Four RGBA pixels at once: transposed so every lane does useful work
+    inline void encodePixels4(__m128 p0, __m128 p1, __m128 p2, __m128 p3,
+                              const ToneMapSettings& settings, const uint8_t* lut, uint32_t* out) {
+        _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+        alignas(16) int32_t r[4], g[4], b[4], a[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(r), encodeIndices(p0, settings));
+        _mm_store_si128(reinterpret_cast<__m128i*>(g), encodeIndices(p1, settings));
+        _mm_store_si128(reinterpret_cast<__m128i*>(b), encodeIndices(p2, settings));
+        _mm_store_si128(reinterpret_cast<__m128i*>(a), encodeAlpha4(p3));
+        for (int i = 0; i < 4; i++) {
+            out[i] = (uint32_t(a[i]) << 24) | (uint32_t(lut[r[i]]) << 16) | (uint32_t(lut[g[i]]) << 8) | lut[b[i]];
+        }
+    }
+#endif
+}
+
+uint16_t FloatToHalf(float value) {
+    uint32_t x = floatBits(value);
+    const uint32_t sign = x & 0x80000000u;
+    x ^= sign;
+
+    uint32_t result;
+    if (x >= 0x47800000u) {
+        // Too big for a half (>= 65536), Inf or NaN
+        result = x > 0x7F800000u ? 0x7E00u : 0x7C00u;
+    } else if (x < 0x38800000u) {
+        // Half denormal or zero: let the FPU round by adding 0.5
+        const uint32_t denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+        result = floatBits(bitsFloat(x) + bitsFloat(denormMagic)) - denormMagic;
+    } else {
+        // Rebias the exponent, round mantissa to nearest even
+        const uint32_t mantissaOdd = (x >> 13) & 1;
+        x += (uint32_t(15 - 127) << 23) + 0xFFF + mantissaOdd;
+        result = x >> 13;
+    }
+    return static_cast<uint16_t>(result | (sign >> 16));
+}
+
+float HalfToFloat(uint16_t value) {
+    const uint32_t shiftedExp = 0x7C00u << 13;
+    uint32_t o = (value & 0x7FFFu) << 13;
+    const uint32_t exp = o & shiftedExp;
+    o += (127 - 15) << 23;
+    if (exp == shiftedExp) {
+        o += (128 - 16) << 23;  // Inf/NaN
+    } else if (exp == 0) {
+        o += 1 << 23;           // Denormal: renormalize
+        o = floatBits(bitsFloat(o) - bitsFloat(113 << 23));
+    }
+    return bitsFloat(o | (uint32_t(value & 0x8000u) << 16));
+}
+
+float SRGBToLinear(uint8_t value) {
+    return tables().toLinear[value];
+}
+
+uint8_t LinearToSRGB(float value) {
+    const float v = ceilOne(floorZero(value));
+    return tables().fromLinear[static_cast<int>(v * (ENCODE_TABLE_SIZE - 1) + 0.5f)];
+}
+
+color DecodeSRGB(uint32_t packed) {
+    const float* lut = tables().toLinear;
+    return color(lut[getRed(packed)], lut[getGreen(packed)], lut[getBlue(packed)], getAlpha(packed) / 255.0f);
+}
+
+HDRBuffer::HDRBuffer(int width, int height, HDRFormat format)
+    : width(0), height(0), format(format) {
+    resize(width, height);
+    clear();
+}
+
+void HDRBuffer::resize(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+    const size_t count = size_t(width) * height * 4;
+    if (format == HDRFormat::Float32) {
+        pixels32.resize(count);
+    } else {
+        pixels16.resize(count);
+    }
+}
+
+bool HDRBuffer::isInBounds(int x, int y) const {
+    return x >= 0 && x < width && y >= 0 && y < height;
+}
+
+void HDRBuffer::setPixel(int x, int y, const color& c) {
+    if (!isInBounds(x, y)) return;
+    const size_t i = (size_t(y) * width + x) * 4;
+    if (format == HDRFormat::Float32) {
+        pixels32[i] = c.r; pixels32[i + 1] = c.g; pixels32[i + 2] = c.b; pixels32[i + 3] = c.a;
+    } else {
+        pixels16[i] = FloatToHalf(c.r); pixels16[i + 1] = FloatToHalf(c.g);
+        pixels16[i + 2] = FloatToHalf(c.b); pixels16[i + 3] = FloatToHalf(c.a);
+    }
+}
+
+color HDRBuffer::getPixel(int x, int y) const {
+    if (!isInBounds(x, y)) return color(0.0f, 0.0f, 0.0f, 0.0f);
+    const size_t i = (size_t(y) * width + x) * 4;
+    if (format == HDRFormat::Float32) {
+        return color(pixels32[i], pixels32[i + 1], pixels32[i + 2], pixels32[i + 3]);
+    }
+    return color(HalfToFloat(pixels16[i]), HalfToFloat(pixels16[i + 1]),
+                 HalfToFloat(pixels16[i + 2]), HalfToFloat(pixels16[i + 3]));
+}
+
+void HDRBuffer::addPixel(int x, int y, const color& c) {
+    if (!isInBounds(x, y)) return;
+    setPixel(x, y, getPixel(x, y) + c);
+}
+
+void HDRBuffer::clear(const color& c) {
+    const size_t count = size_t(width) * height;
+    if (format == HDRFormat::Float32) {
+        for (size_t i = 0; i < count; i++) {
+            float* p = &pixels32[i * 4];
+            p[0] = c.r; p[1] = c.g; p[2] = c.b; p[3] = c.a;
+        }
+    } else {
+        const uint16_t h[4] = { FloatToHalf(c.r), FloatToHalf(c.g), FloatToHalf(c.b), FloatToHalf(c.a) };
+        for (size_t i = 0; i < count; i++) {
+            std::memcpy(&pixels16[i * 4], h, sizeof(h));
+        }
+    }
+}
+
+void ToneMap(const HDRBuffer& source, Framebuffer& destination, const ToneMapSettings& settings, ThreadPool* pool) {
+    const int width = std::min(source.getWidth(), destination.getWidth());
+    const int height = std::min(source.getHeight(), destination.getHeight());
+    const uint8_t* lut = tables().fromLinear;
+    const bool half = source.getFormat() == HDRFormat::Float16;
+
+    const int strips = (height + STRIP_ROWS - 1) / STRIP_ROWS;
+    auto toneMapStrip = [&](int strip, int) {
+        const int begin = strip * STRIP_ROWS;
+        const int end = std::min(height, begin + STRIP_ROWS);
+        for (int y = begin; y < end; y++) {
+            uint32_t* out = destination.data() + size_t(y) * destination.getWidth();
+            const size_t rowStart = size_t(y) * source.getWidth() * 4;
+            int x = 0;
+#ifdef HDR_USE_SSE2
+            if (half) {
+                const uint16_t* in = source.dataHalf() + rowStart;
+                for (; x + 4 <= width; x += 4) {
+                    encodePixels4(halfToFloat4(in + x * 4), halfToFloat4(in + x * 4 + 4),
+                                  halfToFloat4(in + x * 4 + 8), halfToFloat4(in + x * 4 + 12),
+                                  settings, lut, out + x);
+                }
+            } else {
+                const float* in = source.dataFloat() + rowStart;
+                for (; x + 4 <= width; x += 4) {
+                    encodePixels4(_mm_loadu_ps(in + x * 4), _mm_loadu_ps(in + x * 4 + 4),
+                                  _mm_loadu_ps(in + x * 4 + 8), _mm_loadu_ps(in + x * 4 + 12),
+                                  settings, lut, out + x);
+                }
+            }
+#endif
+            for (; x < width; x++) {
+                float rgba[4];
+                for (int c = 0; c < 4; c++) {
+                    rgba[c] = half ? HalfToFloat(source.dataHalf()[rowStart + x * 4 + c])
+                                   : source.dataFloat()[rowStart + x * 4 + c];
+                }
+                out[x] = encodePixelScalar(rgba, settings, lut);
+            }
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(strips, toneMapStrip);
+    } else {
+        for (int strip = 0; strip < strips; strip++) {
+            toneMapStrip(strip, 0);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core/framebuffer.h"
+#include "image/color.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+enum class HDRFormat {
+    Float32,  // 16 bytes per pixel
+    Float16   // 8 bytes per pixel (IEEE half), range up to 65504
+};
+
+enum class ToneMapOperator {
+    Clamp,     // Just clip to [0, 1]
+    Reinhard,  // c / (1 + c)
+    ACES       // Narkowicz's fit of the ACES filmic curve
+};
+
+struct ToneMapSettings {
+    ToneMapOperator op = ToneMapOperator::ACES;
+    float exposure = 1.0f;  // Linear scale applied before the curve
+};
+
+// Linear-light RGBA accumulation target.
+// Unlike Framebuffer, values are linear (not gamma encoded) and unbounded,
+// so lighting can be summed and blended correctly and bright additive
+// effects don't clip. Resolve to a displayable Framebuffer with ToneMap().
+// Straight (non premultiplied) alpha, kept linear as well.
+class HDRBuffer {
+public:
+    HDRBuffer(int width, int height, HDRFormat format = HDRFormat::Float32);
+
+    void setPixel(int x, int y, const color& c);
+    color getPixel(int x, int y) const;
+    void addPixel(int x, int y, const color& c);  // Additive accumulation
+    void clear(const color& c = color(0.0f, 0.0f, 0.0f, 1.0f));
+
+    // Change the dimensions, keeping the allocation when shrinking. Pixel
+    // contents are unspecified afterwards. Unlike Framebuffer::resize this
+    // can't fail: an HDRBuffer always owns its pixels.
+    void resize(int newWidth, int newHeight);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    HDRFormat getFormat() const { return format; }
+
+    // Raw RGBA rows: floats for Float32, halves for Float16 (4 per pixel)
+    const float* dataFloat() const { return pixels32.data(); }
+    const uint16_t* dataHalf() const { return pixels16.data(); }
+
+private:
+    int width;
+    int height;
+    HDRFormat format;
+    std::vector<float> pixels32;
+    std::vector<uint16_t> pixels16;
+
+    bool isInBounds(int x, int y) const;
+};
+
+// Fused exposure + tone curve + sRGB encode into an ARGB8888 framebuffer of
+// the same size. The curves are rational (no pow/exp per pixel) and the sRGB
+// transfer function is a 4096-entry table, so the pass costs a few SIMD
+// multiplies and table reads per pixel. Rows are split over pool (may be null).
+void ToneMap(const HDRBuffer& source, Framebuffer& destination,
+             const ToneMapSettings& settings = ToneMapSettings(), ThreadPool* pool = nullptr);
+
+// sRGB <-> linear conversions through lookup tables
+float SRGBToLinear(uint8_t value);       // 256-entry table, exact
+uint8_t LinearToSRGB(float value);       // 4096-entry table, clamps to [0, 1]
+
+// Decode an ARGB8888 texel or framebuffer pixel to linear light (alpha as is)
+color DecodeSRGB(uint32_t packed);
+
+// IEEE 754 half precision conversions (round to nearest even)
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
@@ -0,0 +1,82 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    for (int i = 1; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int index, int worker)>& fn) {
+    if (count <= 0) {
+        return;
+    }
+    // Nothing to share - skip the handshake
+    if (workers.empty() || count == 1) {
+        for (int i = 0; i < count; i++) {
+            fn(i, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobCount = count;
+        nextIndex.store(0, std::memory_order_relaxed);
+        activeWorkers = static_cast<int>(workers.size());
+        generation++;
+    }
+    wake.notify_all();
+
+    runJobs(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return activeWorkers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::runJobs(int worker) {
+    while (true) {
+        const int index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+        if (index >= jobCount) {
+            break;
+        }
+        (*job)(index, worker);
+    }
+}
+
+void ThreadPool::workerLoop(int worker) {
+    unsigned seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        runJobs(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeWorkers--;
+        }
+        done.notify_one();
+    }
+}
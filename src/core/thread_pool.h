@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops.
+// The calling thread joins in as worker 0, so a pool of N threads spawns N-1
+// helpers. Worker indices are stable and match FrameArena thread slots.
+class ThreadPool {
+public:
+    // threadCount <= 0 picks std::thread::hardware_concurrency()
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    // Prevent copying
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int getThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Run fn(index, worker) for every index in [0, count) and wait for all of
+    // them. Indices are handed out dynamically, so uneven jobs balance out.
+    // Not re-entrant: do not call parallelFor from inside fn.
+    void parallelFor(int count, const std::function<void(int index, int worker)>& fn);
+
+private:
+    void workerLoop(int worker);
+    void runJobs(int worker);
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // Current job, valid while activeWorkers > 0
+    const std::function<void(int, int)>* job = nullptr;
+    int jobCount = 0;
+    std::atomic<int> nextIndex{0};
+    int activeWorkers = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+};
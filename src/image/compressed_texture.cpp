@@ -0,0 +1,374 @@
+#include "compressed_texture.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+#pragma pack(push,1)
+    struct CompressedTextureHeader {
+        char          magic[4] = {'D', 'T', 'E', 'X'};
+        std::uint16_t version = 1;
+        std::uint8_t  format = 0;
+        std::uint8_t  reserved = 0;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+    };
+#pragma pack(pop)
+
+    struct Texel {
+        int r, g, b, a;
+    };
+
+    inline uint32_t packARGB(int r, int g, int b, int a) {
+        return (uint32_t(a) << 24) | (uint32_t(r) << 16) | (uint32_t(g) << 8) | uint32_t(b);
+    }
+
+    // TGA texel (1, 3 or 4 bytes per pixel) -> RGBA
+    Texel readTexel(const TGAImage& image, int x, int y) {
+        TGAColor c = image.get(x, y);
+        if (c.bytespp == 1) return {c[0], c[0], c[0], 255};
+        return {c[2], c[1], c[0], c.bytespp == 4 ? c[3] : 255};
+    }
+
+    inline uint16_t packRGB565(float r, float g, float b) {
+        auto q = [](float v, int maxValue) {
+            return static_cast<int>(std::clamp(v, 0.0f, 255.0f) * maxValue / 255.0f + 0.5f);
+        };
+        return static_cast<uint16_t>((q(r, 31) << 11) | (q(g, 63) << 5) | q(b, 31));
+    }
+
+    inline Texel unpackRGB565(uint16_t c) {
+        const int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+        return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255};
+    }
+
+    // The four colors a BC1/BC3 color block can reference
+    void colorPalette(uint16_t c0, uint16_t c1, bool fourColors, Texel palette[4]) {
+        palette[0] = unpackRGB565(c0);
+        palette[1] = unpackRGB565(c1);
+        const Texel& p0 = palette[0];
+        const Texel& p1 = palette[1];
+        if (fourColors) {
+            palette[2] = {(2 * p0.r + p1.r) / 3, (2 * p0.g + p1.g) / 3, (2 * p0.b + p1.b) / 3, 255};
+            palette[3] = {(p0.r + 2 * p1.r) / 3, (p0.g + 2 * p1.g) / 3, (p0.b + 2 * p1.b) / 3, 255};
+        } else {
+            palette[2] = {(p0.r + p1.r) / 2, (p0.g + p1.g) / 2, (p0.b + p1.b) / 2, 255};
+            palette[3] = {0, 0, 0, 0};
+        }
+    }
+
+    void alphaPalette(int a0, int a1, int palette[8]) {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1) {
+            for (int i = 2; i < 8; i++) palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+        } else {
+            for (int i = 2; i < 6; i++) palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    // Principal-axis endpoint fit: the colors of a 4x4 block usually lie
+    // close to a line through RGB space, so project onto its main direction
+    // and use the extremes (pulled in slightly) as the endpoints.
+    void encodeColorBlock(const Texel texels[16], uint8_t* out) {
+        float mean[3] = {0, 0, 0};
+        for (int i = 0; i < 16; i++) {
+            mean[0] += texels[i].r;
+            mean[1] += texels[i].g;
+            mean[2] += texels[i].b;
+        }
+        for (float& m : mean) m /= 16.0f;
+
+        float cov[6] = {0, 0, 0, 0, 0, 0};  // rr rg rb gg gb bb
+        for (int i = 0; i < 16; i++) {
+            const float r = texels[i].r - mean[0], g = texels[i].g - mean[1], b = texels[i].b - mean[2];
+            cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+            cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+        }
+
+        // Power iteration for the dominant eigenvector, starting from the
+        // covariance column of the channel that varies most
+        float axis[3] = {1.0f, 1.0f, 1.0f};
+        if (cov[0] >= cov[3] && cov[0] >= cov[5]) {
+            if (cov[0] > 0.0f) { axis[0] = cov[0]; axis[1] = cov[1]; axis[2] = cov[2]; }
+        } else if (cov[3] >= cov[5]) {
+            axis[0] = cov[1]; axis[1] = cov[3]; axis[2] = cov[4];
+        } else {
+            axis[0] = cov[2]; axis[1] = cov[4]; axis[2] = cov[5];
+        }
+        for (int iteration = 0; iteration < 4; iteration++) {
+            const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+            const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+            const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+            const float len = std::max({std::fabs(x), std::fabs(y), std::fabs(z)});
+            if (len < 1e-6f) break;
+            axis[0] = x / len; axis[1] = y / len; axis[2] = z / len;
+        }
+        const float axisLen2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+        float minT = 0.0f, maxT = 0.0f;
+        for (int i = 0; i < 16; i++) {
+            const float t = ((texels[i].r - mean[0]) * axis[0] + (texels[i].g - mean[1]) * axis[1] +
+                             (texels[i].b - mean[2]) * axis[2]) / axisLen2;
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+        const float inset = (maxT - minT) / 16.0f;
+        minT += inset;
+        maxT -= inset;
+
+        uint16_t c0 = packRGB565(mean[0] + axis[0] * maxT, mean[1] + axis[1] * maxT, mean[2] + axis[2] * maxT);
+        uint16_t c1 = packRGB565(mean[0] + axis[0] * minT, mean[1] + axis[1] * minT, mean[2] + axis[2] * minT);
+        if (c0 < c1) std::swap(c0, c1);
+
+        uint32_t indices = 0;
+        if (c0 != c1) {
+            Texel palette[4];
+            colorPalette(c0, c1, true, palette);
+            for (int i = 0; i < 16; i++) {
+                int best = 0, bestError = INT32_MAX;
+                for (int p = 0; p < 4; p++) {
+                    const int dr = texels[i].r - palette[p].r;
+                    const int dg = texels[i].g - palette[p].g;
+                    const int db = texels[i].b - palette[p].b;
+                    const int error = dr * dr + dg * dg + db * db;
+                    if (error < bestError) {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+                indices |= uint32_t(best) << (2 * i);
+            }
+        }
+
+        std::memcpy(out, &c0, 2);
+        std::memcpy(out + 2, &c1, 2);
+        std::memcpy(out + 4, &indices, 4);
+    }
+
+    void encodeAlphaBlock(const Texel texels[16], uint8_t* out) {
+        int a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; i++) {
+            a0 = std::max(a0, texels[i].a);
+            a1 = std::min(a1, texels[i].a);
+        }
+
+        uint64_t indices = 0;
+        if (a0 != a1) {
+            int palette[8];
+            alphaPalette(a0, a1, palette);
+            for (int i = 0; i < 16; i++) {
+                int best = 0, bestError = 256;
+                for (int p = 0; p < 8; p++) {
+                    const int error = std::abs(texels[i].a - palette[p]);
+                    if (error < bestError) {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+                indices |= uint64_t(best) << (3 * i);
+            }
+        }
+
+        out[0] = static_cast<uint8_t>(a0);
+        out[1] = static_cast<uint8_t>(a1);
+        for (int i = 0; i < 6; i++) {
+            out[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+        }
+    }
+}
+
+BlockFormat CompressedTexture::pickFormat(const TGAImage& image) {
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            if (readTexel(image, x, y).a != 255) return BlockFormat::BC3;
+        }
+    }
+    return BlockFormat::BC1;
+}
+
+bool CompressedTexture::encode(const TGAImage& image, BlockFormat format) {
+    if (image.width() <= 0 || image.height() <= 0) {
+        std::cerr << "can't compress an empty image\n";
+        return false;
+    }
+    w = image.width();
+    h = image.height();
+    blockFormat = format;
+    blocks.assign(size_t(blocksX()) * blocksY() * bytesPerBlock(), 0);
+
+    Texel texels[16];
+    for (int by = 0; by < blocksY(); by++) {
+        for (int bx = 0; bx < blocksX(); bx++) {
+            for (int i = 0; i < 16; i++) {
+                const int x = std::min(bx * 4 + (i & 3), w - 1);
+                const int y = std::min(by * 4 + (i >> 2), h - 1);
+                texels[i] = readTexel(image, x, y);
+            }
+            uint8_t* block = &blocks[(size_t(by) * blocksX() + bx) * bytesPerBlock()];
+            if (format == BlockFormat::BC3) {
+                encodeAlphaBlock(texels, block);
+                block += 8;
+            }
+            encodeColorBlock(texels, block);
+        }
+    }
+    return true;
+}
+
+void CompressedTexture::decodeBlock(int blockX, int blockY, uint32_t texels[16]) const {
+    const uint8_t* block = &blocks[(size_t(blockY) * blocksX() + blockX) * bytesPerBlock()];
+
+    int alpha[16];
+    if (blockFormat == BlockFormat::BC3) {
+        int palette[8];
+        alphaPalette(block[0], block[1], palette);
+        uint64_t indices = 0;
+        for (int i = 0; i < 6; i++) {
+            indices |= uint64_t(block[2 + i]) << (8 * i);
+        }
+        for (int i = 0; i < 16; i++) {
+            alpha[i] = palette[(indices >> (3 * i)) & 7];
+        }
+        block += 8;
+    }
+
+    uint16_t c0, c1;
+    uint32_t indices;
+    std::memcpy(&c0, block, 2);
+    std::memcpy(&c1, block + 2, 2);
+    std::memcpy(&indices, block + 4, 4);
+
+    // BC3 color blocks always use four colors
+    Texel palette[4];
+    colorPalette(c0, c1, c0 > c1 || blockFormat == BlockFormat::BC3, palette);
+    for (int i = 0; i < 16; i++) {
+        const Texel& t = palette[(indices >> (2 * i)) & 3];
+        texels[i] = packARGB(t.r, t.g, t.b, blockFormat == BlockFormat::BC3 ? alpha[i] : t.a);
+    }
+}
+
+bool CompressedTexture::save(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "can't open file " << filename << "\n";
+        return false;
+    }
+    CompressedTextureHeader header;
+    header.format = static_cast<std::uint8_t>(blockFormat);
+    header.width = static_cast<std::uint32_t>(w);
+    header.height = static_cast<std::uint32_t>(h);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(blocks.data()), blocks.size());
+    if (!out.good()) {
+        std::cerr << "can't dump the compressed texture\n";
+        return false;
+    }
+    return true;
+}
+
+bool CompressedTexture::load(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "can't open file " << filename << "\n";
+        return false;
+    }
+    CompressedTextureHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in.good() || std::memcmp(header.magic, "DTEX", 4) != 0 || header.version != 1) {
+        std::cerr << "not a compressed texture file " << filename << "\n";
+        return false;
+    }
+    if ((header.format != uint8_t(BlockFormat::BC1) && header.format != uint8_t(BlockFormat::BC3)) ||
+        header.width == 0 || header.height == 0 || header.width > 65535 || header.height > 65535) {
+        std::cerr << "bad format (or width/height) value\n";
+        return false;
+    }
+    w = static_cast<int>(header.width);
+    h = static_cast<int>(header.height);
+    blockFormat = static_cast<BlockFormat>(header.format);
+    blocks.resize(size_t(blocksX()) * blocksY() * bytesPerBlock());
+    in.read(reinterpret_cast<char*>(blocks.data()), blocks.size());
+    if (!in.good()) {
+        std::cerr << "an error occured while reading the data\n";
+        blocks.clear();
+        return false;
+    }
+    return true;
+}
+
+bool CompressedTexture::loadCached(const std::string& tgaFilename, const std::string& cacheFilename) {
+    std::error_code error;
+    const auto cacheTime = std::filesystem::last_write_time(cacheFilename, error);
+    if (!error) {
+        const auto sourceTime = std::filesystem::last_write_time(tgaFilename, error);
+        // A cache without its source is still usable
+        if ((error || cacheTime >= sourceTime) && load(cacheFilename)) {
+            return true;
+        }
+    }
+
+    TGAImage image;
+    if (!image.read_tga_file(tgaFilename) || !encode(image, pickFormat(image))) {
+        return false;
+    }
+    // Failing to write the cache only costs the next load some time
+    save(cacheFilename);
+    return true;
+}
+
+TextureSampler::TextureSampler(const CompressedTexture& texture) : texture(texture) {
+    invalidate();
+}
+
+void TextureSampler::invalidate() {
+    std::fill(tags, tags + CACHE_SIZE, 0u);
+}
+
+uint32_t TextureSampler::fetch(int x, int y) {
+    x = std::clamp(x, 0, texture.width() - 1);
+    y = std::clamp(y, 0, texture.height() - 1);
+    const int bx = x >> 2, by = y >> 2;
+
+    // 8x8 blocks of neighbouring blocks map to distinct slots
+    const int slot = (bx & 7) | ((by & 7) << 3);
+    const uint32_t tag = uint32_t(by) * texture.blocksX() + bx + 1;
+    if (tags[slot] != tag) {
+        texture.decodeBlock(bx, by, cache[slot].texels);
+        tags[slot] = tag;
+        misses++;
+    } else {
+        hits++;
+    }
+    return cache[slot].texels[((y & 3) << 2) | (x & 3)];
+}
+
+uint32_t TextureSampler::sampleNearest(float u, float v) {
+    return fetch(static_cast<int>(std::floor(u * texture.width())),
+                 static_cast<int>(std::floor(v * texture.height())));
+}
+
+uint32_t TextureSampler::sampleBilinear(float u, float v) {
+    // 8-bit fixed point weights, texel centers at +0.5
+    const float x = u * texture.width() - 0.5f;
+    const float y = v * texture.height() - 0.5f;
+    const float fx0 = std::floor(x), fy0 = std::floor(y);
+    const int x0 = static_cast<int>(fx0), y0 = static_cast<int>(fy0);
+    const uint32_t wx = static_cast<uint32_t>((x - fx0) * 256.0f);
+    const uint32_t wy = static_cast<uint32_t>((y - fy0) * 256.0f);
+
+    const uint32_t t00 = fetch(x0, y0), t10 = fetch(x0 + 1, y0);
+    const uint32_t t01 = fetch(x0, y0 + 1), t11 = fetch(x0 + 1, y0 + 1);
+
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        const uint32_t top = ((t00 >> shift) & 0xFF) * (256 - wx) + ((t10 >> shift) & 0xFF) * wx;
+        const uint32_t bottom = ((t01 >> shift) & 0xFF) * (256 - wx) + ((t11 >> shift) & 0xFF) * wx;
+        result |= ((top * (256 - wy) + bottom * wy + 32768) >> 16) << shift;
+    }
+    return result;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "tgaimage.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 4x4 block compression formats (the DXT/S3TC layouts GPUs use)
+enum class BlockFormat : uint8_t {
+    BC1 = 1,  // 8 bytes per block: two RGB565 endpoints + 2-bit indices. Opaque.
+    BC3 = 3   // 16 bytes per block: BC1-style color + 8-bit alpha endpoints, 3-bit indices
+};
+
+// Read-only texture kept block compressed in memory: 0.5 (BC1) or 1 (BC3)
+// byte per texel instead of 3-4 for a TGAImage. Texels are never expanded
+// as a whole; TextureSampler decodes the blocks it touches.
+//
+// Blocks are stored row-major. Texel (x, y) uses the same coordinates as
+// TGAImage::get(). Edge blocks of non multiple-of-4 sizes repeat the last
+// row/column.
+class CompressedTexture {
+public:
+    CompressedTexture() = default;
+
+    // Compress an image. BC3 is only worth it when there is real alpha,
+    // see pickFormat().
+    bool encode(const TGAImage& image, BlockFormat format);
+    static BlockFormat pickFormat(const TGAImage& image);
+
+    // Binary cache file ("DTEX" header + raw blocks)
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+
+    // Load a TGA through a compressed cache file: the cache is used if it is
+    // newer than the TGA, otherwise the TGA is compressed and the cache rewritten.
+    bool loadCached(const std::string& tgaFilename, const std::string& cacheFilename);
+
+    // Decode one block into 16 ARGB8888 texels (row-major)
+    void decodeBlock(int blockX, int blockY, uint32_t texels[16]) const;
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int blocksX() const { return (w + 3) / 4; }
+    int blocksY() const { return (h + 3) / 4; }
+    BlockFormat format() const { return blockFormat; }
+    int bytesPerBlock() const { return blockFormat == BlockFormat::BC1 ? 8 : 16; }
+    size_t sizeInBytes() const { return blocks.size(); }
+    bool empty() const { return blocks.empty(); }
+
+private:
+    int w = 0, h = 0;
+    BlockFormat blockFormat = BlockFormat::BC1;
+    std::vector<uint8_t> blocks;
+};
+
+// Samples a CompressedTexture through a small direct-mapped cache of decoded
+// blocks. Neighbouring lookups (bilinear taps, adjacent pixels of a triangle)
+// mostly hit the same few blocks, so each block is decoded once per run of
+// accesses instead of once per tap.
+//
+// NOT thread-safe: give each worker thread its own sampler (they can share
+// the texture).
+class TextureSampler {
+public:
+    explicit TextureSampler(const CompressedTexture& texture);
+
+    // Texel fetch with clamped coordinates, ARGB8888
+    uint32_t fetch(int x, int y);
+
+    // u, v in [0, 1], clamp to edge
+    uint32_t sampleNearest(float u, float v);
+    uint32_t sampleBilinear(float u, float v);
+
+    // Forget cached blocks (needed if the texture was re-encoded or reloaded)
+    void invalidate();
+
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+
+private:
+    static constexpr int CACHE_SIZE = 64;  // Entries, 64 bytes of texels each
+
+    struct alignas(64) CachedBlock {
+        uint32_t texels[16];
+    };
+
+    const CompressedTexture& texture;
+    CachedBlock cache[CACHE_SIZE];
+    uint32_t tags[CACHE_SIZE];  // Block index + 1, 0 = empty
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
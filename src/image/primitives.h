@@ -1,6 +1,7 @@
 #pragma once
 #include "image/color.h"
 #include "core/framebuffer.h"
+#include "rendering/rasterizer.h"
 #include <cmath>
 
 static void DrawLine(int x0, int y0, int x1, int y1, color color, Framebuffer& framebuffer) {
@@ -34,6 +35,29 @@ static void DrawTriangle(int x0, int y0, int x1, int y1, int x2, int y2, color c
     DrawLine(x2, y2, x0, y0, color, framebuffer);
 }
 
+// Filled triangle with sub-pixel vertex positions (see rendering/rasterizer.h).
+// Adjacent triangles sharing an edge never overlap or leave gaps.
+static void FillTriangle(float x0, float y0, float x1, float y1, float x2, float y2, color color, Framebuffer& framebuffer) {
+    const RasterRect clip = { 0, 0, framebuffer.getWidth(), framebuffer.getHeight() };
+    const uint32_t packed = color.toUint32();
+    uint32_t* pixels = framebuffer.data();
+    const int width = framebuffer.getWidth();
+    RasterizeTriangle(x0, y0, x1, y1, x2, y2, clip, [=](int x, int y, float, float, float) {
+        pixels[y * width + x] = packed;
+    });
+}
+
+// Filled triangle with per-vertex colors interpolated across the surface
+static void FillTriangle(float x0, float y0, float x1, float y1, float x2, float y2,
+                         color c0, color c1, color c2, Framebuffer& framebuffer) {
+    const RasterRect clip = { 0, 0, framebuffer.getWidth(), framebuffer.getHeight() };
+    uint32_t* pixels = framebuffer.data();
+    const int width = framebuffer.getWidth();
+    RasterizeTriangle(x0, y0, x1, y1, x2, y2, clip, [&](int x, int y, float l0, float l1, float l2) {
+        pixels[y * width + x] = (c0 * l0 + c1 * l1 + c2 * l2).toUint32();
+    });
+}
+
 static void FillWithGradient(Framebuffer& framebuffer) {
     const int windowHeight = framebuffer.getHeight();
     const int windowWidth = framebuffer.getWidth();
@@ -0,0 +1,21 @@
+#include "tga_export.h"
+
+TGAImage FramebufferToTGA(const Framebuffer& framebuffer) {
+    return FramebufferToTGA(framebuffer, 0, 0, framebuffer.getWidth(), framebuffer.getHeight());
+}
+
+TGAImage FramebufferToTGA(const Framebuffer& framebuffer, int x, int y, int w, int h) {
+    TGAImage image(w, h, TGAImage::RGBA);
+    for (int row = 0; row < h; row++) {
+        for (int col = 0; col < w; col++) {
+            const uint32_t pixel = framebuffer.getPixel(x + col, y + row);
+            TGAColor c;
+            c[0] = getBlue(pixel);
+            c[1] = getGreen(pixel);
+            c[2] = getRed(pixel);
+            c[3] = getAlpha(pixel);
+            image.set(col, row, c);
+        }
+    }
+    return image;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "core/framebuffer.h"
+#include "image/tgaimage.h"
+
+// Copy a framebuffer into a 32-bit TGA image (ARGB8888 -> BGRA bytes)
+TGAImage FramebufferToTGA(const Framebuffer& framebuffer);
+
+// Copy the w x h region starting at (x, y). Pixels outside the framebuffer
+// come out black and transparent.
+TGAImage FramebufferToTGA(const Framebuffer& framebuffer, int x, int y, int w, int h);
@@ -0,0 +1,154 @@
+#include "upscale.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UPSCALE_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // Rows per parallel job
+    constexpr int STRIP_ROWS = 32;
+
+    // Source position of destination pixel i in 24.8 fixed point, centers aligned
+    int sourcePosition(int i, int sourceSize, int destinationSize) {
+        const int64_t pos = ((2 * int64_t(i) + 1) * sourceSize * 256) / (2 * int64_t(destinationSize)) - 128;
+        return static_cast<int>(std::clamp<int64_t>(pos, 0, int64_t(sourceSize - 1) * 256));
+    }
+
+    struct ColumnTable {
+        ArenaSpan<int> x0;               // Left source column
+        ArenaSpan<uint16_t> weights;     // 8 per column: 4x (256 - f), 4x f
+    };
+
+    // Blend two source rows into out (width pixels), fy in [0, 256]
+    void blendRows(const uint32_t* top, const uint32_t* bottom, int fy, uint32_t* out, int width) {
+        if (fy == 0) {
+            std::memcpy(out, top, size_t(width) * 4);
+            return;
+        }
+        int x = 0;
+#ifdef UPSCALE_USE_SSE2
+        // 255 * 256 + 128 < 65536: exact in unsigned 16-bit lanes
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i wTop = _mm_set1_epi16(static_cast<short>(256 - fy));
+        const __m128i wBottom = _mm_set1_epi16(static_cast<short>(fy));
+        const __m128i round = _mm_set1_epi16(128);
+        for (; x + 4 <= width; x += 4) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x));
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), wTop),
+                                       _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), wBottom));
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), wTop),
+                                       _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), wBottom));
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(lo, hi));
+        }
+#endif
+        for (; x < width; x++) {
+            const uint32_t a = top[x], b = bottom[x];
+            uint32_t result = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                const uint32_t c = (((a >> shift) & 0xFF) * (256 - fy) + ((b >> shift) & 0xFF) * fy + 128) >> 8;
+                result |= c << shift;
+            }
+            out[x] = result;
+        }
+    }
+
+    // Horizontal pass: row holds sourceWidth + 1 pixels (last one repeated)
+    void resampleRow(const uint32_t* row, const ColumnTable& columns, uint32_t* out, int width) {
+        int x = 0;
+#ifdef UPSCALE_USE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(128);
+        auto weighPair = [&](int i) {
+            // [left BGRA, right BGRA] scaled by their weights
+            const __m128i pair = _mm_unpacklo_epi8(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + columns.x0[i])), zero);
+            const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&columns.weights[size_t(i) * 8]));
+            return _mm_mullo_epi16(pair, w);
+        };
+        for (; x + 2 <= width; x += 2) {
+            const __m128i p = weighPair(x);
+            const __m128i q = weighPair(x + 1);
+            __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(p, q), _mm_unpackhi_epi64(p, q));
+            sum = _mm_srli_epi16(_mm_add_epi16(sum, round), 8);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(sum, sum));
+        }
+#endif
+        for (; x < width; x++) {
+            const uint32_t a = row[columns.x0[x]], b = row[columns.x0[x] + 1];
+            const uint32_t wa = columns.weights[size_t(x) * 8];
+            const uint32_t wb = columns.weights[size_t(x) * 8 + 4];
+            uint32_t result = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                const uint32_t c = (((a >> shift) & 0xFF) * wa + ((b >> shift) & 0xFF) * wb + 128) >> 8;
+                result |= c << shift;
+            }
+            out[x] = result;
+        }
+    }
+}
+
+void UpscaleBilinear(const Framebuffer& source, Framebuffer& destination, ThreadPool* pool,
+                     LinearArena* scratch) {
+    const int srcW = source.getWidth(), srcH = source.getHeight();
+    const int dstW = destination.getWidth(), dstH = destination.getHeight();
+    if (srcW <= 0 || srcH <= 0 || dstW <= 0 || dstH <= 0) {
+        return;
+    }
+    if (srcW == dstW && srcH == dstH) {
+        std::memcpy(destination.data(), source.data(), size_t(srcW) * srcH * 4);
+        return;
+    }
+
+    LinearArena temporary;
+    LinearArena& arena = scratch ? *scratch : temporary;
+
+    ColumnTable columns;
+    columns.x0 = arena.allocSpan<int>(dstW);
+    columns.weights = arena.allocSpan<uint16_t>(size_t(dstW) * 8);
+    for (int x = 0; x < dstW; x++) {
+        const int pos = sourcePosition(x, srcW, dstW);
+        const uint16_t f = static_cast<uint16_t>(pos & 0xFF);
+        columns.x0[x] = pos >> 8;
+        std::fill_n(&columns.weights[size_t(x) * 8], 4, static_cast<uint16_t>(256 - f));
+        std::fill_n(&columns.weights[size_t(x) * 8 + 4], 4, f);
+    }
+
+    // One padded scratch row per thread, each on its own cache lines; the
+    // extra pixel lets the last column read its right neighbour without a branch
+    const int threads = pool ? pool->getThreadCount() : 1;
+    const size_t rowStride = (size_t(srcW) + 1 + 15) & ~size_t(15);
+    uint32_t* rows = static_cast<uint32_t*>(arena.allocate(rowStride * threads * 4, 64));
+
+    const uint32_t* src = source.data();
+    uint32_t* dst = destination.data();
+
+    const int strips = (dstH + STRIP_ROWS - 1) / STRIP_ROWS;
+    auto upscaleStrip = [&](int strip, int worker) {
+        uint32_t* blended = rows + rowStride * worker;
+        const int begin = strip * STRIP_ROWS;
+        const int end = std::min(dstH, begin + STRIP_ROWS);
+        for (int y = begin; y < end; y++) {
+            const int pos = sourcePosition(y, srcH, dstH);
+            const int y0 = pos >> 8;
+            const int y1 = std::min(y0 + 1, srcH - 1);
+            blendRows(src + size_t(y0) * srcW, src + size_t(y1) * srcW, pos & 0xFF, blended, srcW);
+            blended[srcW] = blended[srcW - 1];
+            resampleRow(blended, columns, dst + size_t(y) * dstW, dstW);
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(strips, upscaleStrip);
+    } else {
+        for (int strip = 0; strip < strips; strip++) {
+            upscaleStrip(strip, 0);
+        }
+    }
+}
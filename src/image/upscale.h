@@ -0,0 +1,17 @@
+#pragma once
+
+#include "core/frame_arena.h"
+#include "core/framebuffer.h"
+
+class ThreadPool;
+
+// Bilinear resample of source into destination's size (usually a low-res
+// render target into the window-sized buffer that gets presented).
+// Pixel centers are aligned, edges are clamped, 8-bit fixed point weights.
+// Rows are split into strips over pool (may be null). Equal sizes copy.
+//
+// The column table and one scratch row per pool thread come from scratch
+// (may be null: a temporary arena is used). Reset it once per frame and
+// steady-state frames upscale without touching the heap.
+void UpscaleBilinear(const Framebuffer& source, Framebuffer& destination, ThreadPool* pool = nullptr,
+                     LinearArena* scratch = nullptr);
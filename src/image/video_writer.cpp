@@ -0,0 +1,312 @@
+#include "video_writer.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VIDEO_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+    // BT.601 limited range, 8-bit fixed point coefficients
+    inline uint8_t lumaOf(uint32_t p) {
+        const int r = getRed(p), g = getGreen(p), b = getBlue(p);
+        return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    }
+
+    // r, g, b are sums over a 2x2 block (4 samples)
+    inline uint8_t chromaU(int r, int g, int b) {
+        return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+    }
+
+    inline uint8_t chromaV(int r, int g, int b) {
+        return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+    }
+
+    // Pixels [x, width) of one row, one at a time
+    void lumaRow(const uint32_t* src, uint8_t* dst, int x, int width) {
+        for (; x < width; x++) {
+            dst[x] = lumaOf(src[x]);
+        }
+    }
+
+    // Chroma samples [cx, (width + 1) / 2) of one row pair, one at a time
+    void chromaRow(const uint32_t* top, const uint32_t* bottom, uint8_t* u, uint8_t* v, int cx, int width) {
+        const int chromaWidth = (width + 1) / 2;
+        for (; cx < chromaWidth; cx++) {
+            const int x0 = 2 * cx;
+            const int x1 = std::min(x0 + 1, width - 1);
+            const uint32_t p[4] = { top[x0], top[x1], bottom[x0], bottom[x1] };
+            int r = 0, g = 0, b = 0;
+            for (uint32_t pixel : p) {
+                r += getRed(pixel);
+                g += getGreen(pixel);
+                b += getBlue(pixel);
+            }
+            u[cx] = chromaU(r, g, b);
+            v[cx] = chromaV(r, g, b);
+        }
+    }
+
+    // Rows per parallel job (even, so strips never split a chroma row)
+    constexpr int STRIP_ROWS = 32;
+
+#ifdef VIDEO_USE_SSE2
+    // 8 pixels -> 8 luma bytes
+    inline __m128i luma8(__m128i p0, __m128i p1) {
+        const __m128i mask = _mm_set1_epi32(0xFF);
+        const __m128i r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask),
+                                          _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+        const __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask),
+                                          _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+        const __m128i b = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+
+        // Max sum is 220 * 255 + 128 < 65536: exact in unsigned 16-bit lanes
+        __m128i y = _mm_mullo_epi16(r, _mm_set1_epi16(66));
+        y = _mm_add_epi16(y, _mm_mullo_epi16(g, _mm_set1_epi16(129)));
+        y = _mm_add_epi16(y, _mm_mullo_epi16(b, _mm_set1_epi16(25)));
+        y = _mm_add_epi16(y, _mm_set1_epi16(128));
+        y = _mm_add_epi16(_mm_srli_epi16(y, 8), _mm_set1_epi16(16));
+        return _mm_packus_epi16(y, y);
+    }
+
+    // Two rows of 4 pixels -> BGRA channel sums of the two 2x2 blocks,
+    // as 16-bit lanes [B G R A | B G R A]
+    inline __m128i blockSums2(__m128i top, __m128i bottom) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+        const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+        return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+    }
+
+    // Dot product of each block's [B G R A] with coefs -> 32-bit in lanes 0 and 1
+    inline __m128i chromaDot2(__m128i sums, __m128i coefs) {
+        __m128i t = _mm_madd_epi16(sums, coefs);          // [BG, RA, BG, RA]
+        t = _mm_add_epi32(t, _mm_srli_epi64(t, 32));      // lanes 0 and 2
+        return _mm_shuffle_epi32(t, _MM_SHUFFLE(3, 1, 2, 0));
+    }
+
+    // 4 chroma sums -> 4 bytes
+    inline uint32_t chromaPack4(__m128i d01, __m128i d23) {
+        __m128i v = _mm_unpacklo_epi64(d01, d23);
+        v = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(v, _mm_set1_epi32(512)), 10), _mm_set1_epi32(128));
+        v = _mm_packs_epi32(v, v);
+        v = _mm_packus_epi16(v, v);
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+    }
+#endif
+}
+
+void ConvertARGBToI420(const uint32_t* argb, int width, int height,
+                       uint8_t* yPlane, uint8_t* uPlane, uint8_t* vPlane,
+                       int rowBegin, int rowEnd) {
+    const int chromaWidth = (width + 1) / 2;
+
+    // Luma
+    for (int y = rowBegin; y < rowEnd; y++) {
+        const uint32_t* src = argb + size_t(y) * width;
+        uint8_t* dst = yPlane + size_t(y) * width;
+        int x = 0;
+#ifdef VIDEO_USE_SSE2
+        for (; x + 8 <= width; x += 8) {
+            const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+            const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + 4));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), luma8(p0, p1));
+        }
+#endif
+        lumaRow(src, dst, x, width);
+    }
+
+    // Chroma: one sample per 2x2 block, edges replicate the last pixel
+    for (int y = rowBegin; y < rowEnd; y += 2) {
+        const uint32_t* top = argb + size_t(y) * width;
+        const uint32_t* bottom = argb + size_t(std::min(y + 1, height - 1)) * width;
+        uint8_t* u = uPlane + size_t(y / 2) * chromaWidth;
+        uint8_t* v = vPlane + size_t(y / 2) * chromaWidth;
+        int cx = 0;
+#ifdef VIDEO_USE_SSE2
+        const __m128i coefU = _mm_setr_epi16(112, -74, -38, 0, 112, -74, -38, 0);
+        const __m128i coefV = _mm_setr_epi16(-18, -94, 112, 0, -18, -94, 112, 0);
+        for (; 2 * cx + 8 <= width; cx += 4) {
+            const __m128i t0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + 2 * cx));
+            const __m128i t1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + 2 * cx + 4));
+            const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + 2 * cx));
+            const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + 2 * cx + 4));
+            const __m128i s01 = blockSums2(t0, b0);
+            const __m128i s23 = blockSums2(t1, b1);
+            const uint32_t u4 = chromaPack4(chromaDot2(s01, coefU), chromaDot2(s23, coefU));
+            const uint32_t v4 = chromaPack4(chromaDot2(s01, coefV), chromaDot2(s23, coefV));
+            std::memcpy(u + cx, &u4, 4);
+            std::memcpy(v + cx, &v4, 4);
+        }
+#endif
+        chromaRow(top, bottom, u, v, cx, width);
+    }
+}
+
+void ConvertARGBToI420Scalar(const uint32_t* argb, int width, int height,
+                             uint8_t* yPlane, uint8_t* uPlane, uint8_t* vPlane,
+                             int rowBegin, int rowEnd) {
+    const int chromaWidth = (width + 1) / 2;
+    for (int y = rowBegin; y < rowEnd; y++) {
+        lumaRow(argb + size_t(y) * width, yPlane + size_t(y) * width, 0, width);
+    }
+    for (int y = rowBegin; y < rowEnd; y += 2) {
+        chromaRow(argb + size_t(y) * width, argb + size_t(std::min(y + 1, height - 1)) * width,
+                  uPlane + size_t(y / 2) * chromaWidth, vPlane + size_t(y / 2) * chromaWidth, 0, width);
+    }
+}
+
+VideoWriter::VideoWriter(const std::string& path, int width, int height, VideoFormat format,
+                         int framesPerSecond, ThreadPool* pool)
+    : width(width), height(height), format(format), pool(pool) {
+    // The Y4M header needs a positive frame rate; F0:1 is not a valid stream
+    if (format == VideoFormat::Y4M && framesPerSecond <= 0) {
+        return;
+    }
+    if (path == "-") {
+        file = stdout;
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    } else {
+        file = std::fopen(path.c_str(), "wb");
+        ownsFile = true;
+    }
+    if (!file) {
+        return;
+    }
+    // Frames are written in one call each; a large buffer just adds a copy
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+
+    size_t frameBytes;
+    if (format == VideoFormat::Y4M) {
+        std::fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, framesPerSecond);
+        const size_t chroma = size_t((width + 1) / 2) * ((height + 1) / 2);
+        frameBytes = 6 + size_t(width) * height + 2 * chroma;  // "FRAME\n" + planes
+    } else {
+        frameBytes = size_t(width) * height * 4;
+    }
+    for (FrameSlot& slot : slots) {
+        slot.bytes.resize(frameBytes);
+    }
+
+    writer = std::thread(&VideoWriter::writerLoop, this);
+}
+
+VideoWriter::~VideoWriter() {
+    close();
+}
+
+void VideoWriter::convert(const Framebuffer& framebuffer, uint8_t* out) {
+    const uint32_t* pixels = framebuffer.data();
+
+    if (format == VideoFormat::RawBGRA) {
+        // ARGB8888 words are stored B, G, R, A on little-endian machines
+        std::memcpy(out, pixels, size_t(width) * height * 4);
+        return;
+    }
+
+    std::memcpy(out, "FRAME\n", 6);
+    uint8_t* yPlane = out + 6;
+    uint8_t* uPlane = yPlane + size_t(width) * height;
+    uint8_t* vPlane = uPlane + size_t((width + 1) / 2) * ((height + 1) / 2);
+
+    const int strips = (height + STRIP_ROWS - 1) / STRIP_ROWS;
+    auto convertStrip = [&](int strip, int) {
+        const int begin = strip * STRIP_ROWS;
+        const int end = std::min(height, begin + STRIP_ROWS);
+        ConvertARGBToI420(pixels, width, height, yPlane, uPlane, vPlane, begin, end);
+    };
+
+    if (pool) {
+        pool->parallelFor(strips, convertStrip);
+    } else {
+        for (int strip = 0; strip < strips; strip++) {
+            convertStrip(strip, 0);
+        }
+    }
+}
+
+bool VideoWriter::writeFrame(const Framebuffer& framebuffer) {
+    if (!file || framebuffer.getWidth() != width || framebuffer.getHeight() != height) {
+        return false;
+    }
+
+    FrameSlot& slot = slots[produceIndex];
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return !slot.full || failed; });
+        if (failed) {
+            return false;
+        }
+    }
+
+    // The writer thread never touches a slot that isn't full
+    convert(framebuffer, slot.bytes.data());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slot.full = true;
+    }
+    changed.notify_all();
+    produceIndex ^= 1;
+    return true;
+}
+
+void VideoWriter::writerLoop() {
+    int consumeIndex = 0;
+    while (true) {
+        FrameSlot& slot = slots[consumeIndex];
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return slot.full || closing; });
+            if (!slot.full) {
+                return;  // Closing and nothing left to write
+            }
+        }
+
+        const bool ok = std::fwrite(slot.bytes.data(), 1, slot.bytes.size(), file) == slot.bytes.size();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            slot.full = false;
+            if (!ok) {
+                failed = true;
+            }
+        }
+        if (ok) {
+            framesWritten++;
+        }
+        changed.notify_all();
+        consumeIndex ^= 1;
+    }
+}
+
+bool VideoWriter::close() {
+    if (!file) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    changed.notify_all();
+    if (writer.joinable()) {
+        writer.join();
+    }
+
+    bool ok = !failed && std::fflush(file) == 0;
+    if (ownsFile) {
+        ok = (std::fclose(file) == 0) && ok;
+    }
+    file = nullptr;
+    return ok;
+}
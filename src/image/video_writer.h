@@ -0,0 +1,91 @@
+#pragma once
+
+#include "core/framebuffer.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ThreadPool;
+
+enum class VideoFormat {
+    Y4M,        // YUV4MPEG2, 4:2:0 (I420) - readable by ffmpeg, x264, mpv...
+    RawBGRA,    // Headerless 32-bit frames, byte order B, G, R, A
+};
+
+// Streams frames to a file or to stdout ("-") so an external encoder can
+// consume them directly, e.g.
+//     renderer_offline --video - | ffmpeg -i - out.mp4
+//
+// Frames are converted into one of two buffers while a background thread
+// writes the other, so conversion of frame N+1 overlaps the write of frame N.
+// ARGB -> I420 conversion uses SSE2 when available and is split across row
+// strips on the given ThreadPool.
+class VideoWriter {
+public:
+    // pool may be null (convert on the calling thread). The writer is not
+    // opened if the output can't be, or if a Y4M stream gets framesPerSecond <= 0.
+    VideoWriter(const std::string& path, int width, int height, VideoFormat format,
+                int framesPerSecond = 30, ThreadPool* pool = nullptr);
+    ~VideoWriter();
+
+    // Prevent copying
+    VideoWriter(const VideoWriter&) = delete;
+    VideoWriter& operator=(const VideoWriter&) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+
+    // Queue one frame (must match the writer's dimensions). Blocks only if
+    // the writer thread is still busy with the frame before the previous one.
+    // Returns false once any write has failed.
+    bool writeFrame(const Framebuffer& framebuffer);
+
+    // Flush pending frames and close the output. Called by the destructor.
+    // Returns false if any write failed.
+    bool close();
+
+    int getFramesWritten() const { return framesWritten; }
+
+private:
+    struct FrameSlot {
+        std::vector<uint8_t> bytes;
+        bool full = false;
+    };
+
+    void writerLoop();
+    void convert(const Framebuffer& framebuffer, uint8_t* out);
+
+    FILE* file = nullptr;
+    bool ownsFile = false;
+    int width;
+    int height;
+    VideoFormat format;
+    ThreadPool* pool;
+
+    FrameSlot slots[2];
+    int produceIndex = 0;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread writer;
+    bool closing = false;
+    bool failed = false;
+    std::atomic<int> framesWritten{0};
+};
+
+// ARGB8888 -> I420 (BT.601 limited range). Converts rows [rowBegin, rowEnd)
+// of the luma plane and the matching chroma rows; rowBegin must be even.
+// Odd sizes replicate the last column/row into the chroma average.
+void ConvertARGBToI420(const uint32_t* argb, int width, int height,
+                       uint8_t* yPlane, uint8_t* uPlane, uint8_t* vPlane,
+                       int rowBegin, int rowEnd);
+
+// Plain C++ version of ConvertARGBToI420 with the same arguments. Produces
+// identical bytes; the SIMD path is checked against it.
+void ConvertARGBToI420Scalar(const uint32_t* argb, int width, int height,
+                             uint8_t* yPlane, uint8_t* uPlane, uint8_t* vPlane,
+                             int rowBegin, int rowEnd);
@@ -1,7 +1,12 @@
 #pragma once
 #include "core/window.h"
 #include "core/framebuffer.h"
-#include "image/primitives.h"
+#include "core/thread_pool.h"
+#include "image/upscale.h"
+#include "rendering/command_buffer.h"
+#include "rendering/resolution_scaler.h"
+#include "rendering/tile_cache.h"
+#include <chrono>
 #include <iostream>
 
 const int WINDOW_WIDTH = 800;
@@ -13,10 +18,29 @@ int main(int argc, char* argv[]) {
         Window window("DIY Software Renderer", WINDOW_WIDTH, WINDOW_HEIGHT);
         Framebuffer framebuffer(WINDOW_WIDTH, WINDOW_HEIGHT);
 
+        // Internal render target; its resolution follows the frame-time
+        // budget and it is upscaled into framebuffer for display
+        Framebuffer renderTarget(WINDOW_WIDTH, WINDOW_HEIGHT);
+        ResolutionScaler resolutionScaler;
+        LinearArena upscaleScratch;
+
         std::cout << "DIY Renderer started!" << std::endl;
         std::cout << "Resolution: " << WINDOW_WIDTH << "x" << WINDOW_HEIGHT << std::endl;
         std::cout << "Press ESC to quit" << std::endl;
 
+        // Worker threads for replaying recorded draw calls
+        ThreadPool threadPool;
+        RenderQueue renderQueue;
+
+        // Only tiles whose draw calls changed since last frame are redrawn
+        TileCache tileCache;
+
+        // Frame-static background: recorded once per render size, resubmitted every frame
+        CommandBuffer backgroundLayer;
+
+        // Re-recorded every frame
+        CommandBuffer sceneLayer;
+
         bool running = true;
         SDL_Event event;
 
@@ -33,22 +57,57 @@ int main(int argc, char* argv[]) {
                 }
             }
 
-            // Clear framebuffer
-            framebuffer.clear(makeColor(0, 0, 0));  // Black background
+            const auto frameStart = std::chrono::steady_clock::now();
+
+            // Pick this frame's internal resolution
+            int width = 0, height = 0;
+            resolutionScaler.getRenderSize(WINDOW_WIDTH, WINDOW_HEIGHT, width, height);
+            if (backgroundLayer.getCommands().empty() || width != renderTarget.getWidth() || height != renderTarget.getHeight()) {
+                if (!renderTarget.resize(width, height)) {
+                    // Can't change size: keep rendering at the size it has
+                    width = renderTarget.getWidth();
+                    height = renderTarget.getHeight();
+                }
+                backgroundLayer.reset();
+                backgroundLayer.setLayer(0);
+                backgroundLayer.fillWithGradient();
+                backgroundLayer.setLayer(1);
+                backgroundLayer.drawLine(0, height/2, width, height/2, color::red()); // X-axis
+                backgroundLayer.drawLine(width/2, 0, width/2, height, color::green()); // Y-axis
+            }
 
             // ========================================
             // YOUR RENDERING CODE GOES HERE!
             // ========================================
 
-            // Draw a simple gradient
-            FillWithGradient (framebuffer);
-            // Then draw a red line over that
-            DrawLine(0, WINDOW_HEIGHT/2, WINDOW_WIDTH, WINDOW_HEIGHT/2, color::red(), framebuffer); // X-axis
-            DrawLine(WINDOW_WIDTH/2, 0, WINDOW_WIDTH/2, WINDOW_HEIGHT, color::green(), framebuffer); // Y-axis
-            DrawTriangle(WINDOW_WIDTH/2      , WINDOW_HEIGHT/4
-                        , WINDOW_WIDTH*3/4, WINDOW_HEIGHT*3/4
-                        , WINDOW_WIDTH/4, WINDOW_HEIGHT*3/4
-                        , color::cyan(), framebuffer);
+            // Record this frame's draw calls (nothing is drawn yet)
+            sceneLayer.reset();
+            // Filled triangle with sub-pixel vertices, outlined on top
+            sceneLayer.setLayer(2);
+            sceneLayer.fillTriangle(width/2.0f   , height/4.0f
+                                   , width*3/4.0f, height*3/4.0f
+                                   , width/4.0f  , height*3/4.0f
+                                   , color::red(), color::green(), color::blue());
+            sceneLayer.setLayer(3);
+            sceneLayer.drawTriangle(width/2      , height/4
+                                   , width*3/4, height*3/4
+                                   , width/4, height*3/4
+                                   , color::cyan());
+
+            // Replay in sorted order across the worker threads, skipping
+            // tiles that look exactly like last frame. The gradient covers
+            // the whole screen, so no clear is needed.
+            renderQueue.reset();
+            renderQueue.submit(backgroundLayer);
+            renderQueue.submit(sceneLayer);
+            tileCache.execute(renderQueue, renderTarget, &threadPool);
+
+            // Scale up to window size (a plain copy at full resolution)
+            upscaleScratch.reset();
+            UpscaleBilinear(renderTarget, framebuffer, &threadPool, &upscaleScratch);
+
+            const std::chrono::duration<double, std::milli> frameTime = std::chrono::steady_clock::now() - frameStart;
+            resolutionScaler.update(frameTime.count());
 
             // Display framebuffer
             window.present(framebuffer.data());
@@ -1,10 +1,13 @@
 #pragma once
+#include "simd.h"
 #include "vec3.h"
+#include "vec4.h"
 #include <cmath>
 
 // 4x4 matrix for 3D transformations
 // Column-major order (OpenGL style) - columns are stored contiguously
-class mat4 {
+// Aligned so each column loads straight into an SSE register
+class alignas(16) mat4 {
 #pragma region DATA
 public:
     // Data stored in column-major order: m[column][row]
@@ -48,8 +51,24 @@ public:
 #pragma region OPERATORS
 public:
     // Matrix multiplication
+    // Each result column is a linear combination of this matrix's columns,
+    // which maps directly onto 4-wide SIMD lanes.
     mat4 operator*(const mat4& other) const {
         mat4 result(0.0f);
+#ifdef MATH_USE_SSE
+        const __m128 c0 = _mm_load_ps(m[0]);
+        const __m128 c1 = _mm_load_ps(m[1]);
+        const __m128 c2 = _mm_load_ps(m[2]);
+        const __m128 c3 = _mm_load_ps(m[3]);
+        for (int col = 0; col < 4; col++) {
+            const float* b = other.m[col];
+            __m128 r = _mm_mul_ps(c0, _mm_set1_ps(b[0]));
+            r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(b[1])));
+            r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(b[2])));
+            r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_set1_ps(b[3])));
+            _mm_store_ps(result.m[col], r);
+        }
+#else
         for (int col = 0; col < 4; col++) {
             for (int row = 0; row < 4; row++) {
                 result.m[col][row] =
@@ -59,6 +78,7 @@ public:
                     m[3][row] * other.m[col][3];
             }
         }
+#endif
         return result;
     }
 
@@ -72,6 +92,24 @@ public:
         );
     }
 
+    // Matrix-vector multiplication (homogeneous, no divide)
+    vec4 operator*(const vec4& v) const {
+#ifdef MATH_USE_SSE
+        __m128 r = _mm_mul_ps(_mm_load_ps(m[0]), _mm_set1_ps(v.x));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m[1]), _mm_set1_ps(v.y)));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m[2]), _mm_set1_ps(v.z)));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m[3]), _mm_set1_ps(v.w)));
+        return vec4(r);
+#else
+        return vec4(
+            m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z + m[3][0] * v.w,
+            m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z + m[3][1] * v.w,
+            m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z + m[3][2] * v.w,
+            m[0][3] * v.x + m[1][3] * v.y + m[2][3] * v.z + m[3][3] * v.w
+        );
+#endif
+    }
+
     // Compound assignment
     mat4& operator*=(const mat4& other) {
         *this = *this * other;
@@ -248,6 +286,93 @@ public:
         return result;
     }
 
+    // True if the bottom row is (0, 0, 0, 1), i.e. no projection
+    bool isAffine() const {
+        return m[0][3] == 0.0f && m[1][3] == 0.0f && m[2][3] == 0.0f && m[3][3] == 1.0f;
+    }
+
+    // Transform a direction (w=0): ignores translation, no perspective divide
+    vec3 transformDirection(const vec3& v) const {
+        return vec3(
+            m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z,
+            m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z,
+            m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z
+        );
+    }
+
+    // Inverse of an affine matrix (rotation/scale/shear + translation).
+    // Inverts only the upper 3x3 and back-transforms the translation, which
+    // is much cheaper than the general 4x4 inverse. Singular input gives identity.
+    mat4 inverseAffine() const {
+        mat4 result;
+        if (!invert3x3(result)) {
+            return mat4();
+        }
+        // t' = -R^-1 * t
+        const float tx = m[3][0], ty = m[3][1], tz = m[3][2];
+        result.m[3][0] = -(result.m[0][0] * tx + result.m[1][0] * ty + result.m[2][0] * tz);
+        result.m[3][1] = -(result.m[0][1] * tx + result.m[1][1] * ty + result.m[2][1] * tz);
+        result.m[3][2] = -(result.m[0][2] * tx + result.m[1][2] * ty + result.m[2][2] * tz);
+        return result;
+    }
+
+    // General inverse (cofactor expansion). Uses the affine fast path when
+    // possible. Singular input gives identity.
+    mat4 inverse() const {
+        if (isAffine()) {
+            return inverseAffine();
+        }
+
+        const float* a = data();
+        float inv[16];
+        inv[0]  =  a[5]*a[10]*a[15] - a[5]*a[11]*a[14] - a[9]*a[6]*a[15] + a[9]*a[7]*a[14] + a[13]*a[6]*a[11] - a[13]*a[7]*a[10];
+        inv[4]  = -a[4]*a[10]*a[15] + a[4]*a[11]*a[14] + a[8]*a[6]*a[15] - a[8]*a[7]*a[14] - a[12]*a[6]*a[11] + a[12]*a[7]*a[10];
+        inv[8]  =  a[4]*a[9]*a[15]  - a[4]*a[11]*a[13] - a[8]*a[5]*a[15] + a[8]*a[7]*a[13] + a[12]*a[5]*a[11] - a[12]*a[7]*a[9];
+        inv[12] = -a[4]*a[9]*a[14]  + a[4]*a[10]*a[13] + a[8]*a[5]*a[14] - a[8]*a[6]*a[13] - a[12]*a[5]*a[10] + a[12]*a[6]*a[9];
+        inv[1]  = -a[1]*a[10]*a[15] + a[1]*a[11]*a[14] + a[9]*a[2]*a[15] - a[9]*a[3]*a[14] - a[13]*a[2]*a[11] + a[13]*a[3]*a[10];
+        inv[5]  =  a[0]*a[10]*a[15] - a[0]*a[11]*a[14] - a[8]*a[2]*a[15] + a[8]*a[3]*a[14] + a[12]*a[2]*a[11] - a[12]*a[3]*a[10];
+        inv[9]  = -a[0]*a[9]*a[15]  + a[0]*a[11]*a[13] + a[8]*a[1]*a[15] - a[8]*a[3]*a[13] - a[12]*a[1]*a[11] + a[12]*a[3]*a[9];
+        inv[13] =  a[0]*a[9]*a[14]  - a[0]*a[10]*a[13] - a[8]*a[1]*a[14] + a[8]*a[2]*a[13] + a[12]*a[1]*a[10] - a[12]*a[2]*a[9];
+        inv[2]  =  a[1]*a[6]*a[15]  - a[1]*a[7]*a[14]  - a[5]*a[2]*a[15] + a[5]*a[3]*a[14] + a[13]*a[2]*a[7]  - a[13]*a[3]*a[6];
+        inv[6]  = -a[0]*a[6]*a[15]  + a[0]*a[7]*a[14]  + a[4]*a[2]*a[15] - a[4]*a[3]*a[14] - a[12]*a[2]*a[7]  + a[12]*a[3]*a[6];
+        inv[10] =  a[0]*a[5]*a[15]  - a[0]*a[7]*a[13]  - a[4]*a[1]*a[15] + a[4]*a[3]*a[13] + a[12]*a[1]*a[7]  - a[12]*a[3]*a[5];
+        inv[14] = -a[0]*a[5]*a[14]  + a[0]*a[6]*a[13]  + a[4]*a[1]*a[14] - a[4]*a[2]*a[13] - a[12]*a[1]*a[6]  + a[12]*a[2]*a[5];
+        inv[3]  = -a[1]*a[6]*a[11]  + a[1]*a[7]*a[10]  + a[5]*a[2]*a[11] - a[5]*a[3]*a[10] - a[9]*a[2]*a[7]   + a[9]*a[3]*a[6];
+        inv[7]  =  a[0]*a[6]*a[11]  - a[0]*a[7]*a[10]  - a[4]*a[2]*a[11] + a[4]*a[3]*a[10] + a[8]*a[2]*a[7]   - a[8]*a[3]*a[6];
+        inv[11] = -a[0]*a[5]*a[11]  + a[0]*a[7]*a[9]   + a[4]*a[1]*a[11] - a[4]*a[3]*a[9]  - a[8]*a[1]*a[7]   + a[8]*a[3]*a[5];
+        inv[15] =  a[0]*a[5]*a[10]  - a[0]*a[6]*a[9]   - a[4]*a[1]*a[10] + a[4]*a[2]*a[9]  + a[8]*a[1]*a[6]   - a[8]*a[2]*a[5];
+
+        const float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+        if (det == 0.0f) {
+            return mat4();
+        }
+
+        const float invDet = 1.0f / det;
+        mat4 result;
+        float* r = result.data();
+        for (int i = 0; i < 16; i++) {
+            r[i] = inv[i] * invDet;
+        }
+        return result;
+    }
+
+    // Matrix for transforming normals: transpose of the inverse of the upper
+    // 3x3, with translation removed. Use with transformDirection() and
+    // renormalize afterwards if the matrix contains scale.
+    mat4 inverseTranspose() const {
+        mat4 inv;
+        if (!invert3x3(inv)) {
+            return mat4();
+        }
+        mat4 result;
+        for (int col = 0; col < 3; col++) {
+            for (int row = 0; row < 3; row++) {
+                result.m[col][row] = inv.m[row][col];
+            }
+        }
+        return result;
+    }
+
     // Get pointer to data (useful for OpenGL)
     const float* data() const {
         return &m[0][0];
@@ -257,4 +382,36 @@ public:
         return &m[0][0];
     }
 #pragma endregion
+
+#pragma region HELPERS
+private:
+    // Write the inverse of the upper 3x3 into out (rest of out untouched).
+    // Returns false if the 3x3 block is singular.
+    bool invert3x3(mat4& out) const {
+        const float a00 = m[0][0], a01 = m[0][1], a02 = m[0][2];
+        const float a10 = m[1][0], a11 = m[1][1], a12 = m[1][2];
+        const float a20 = m[2][0], a21 = m[2][1], a22 = m[2][2];
+
+        const float c00 = a11 * a22 - a12 * a21;
+        const float c10 = a12 * a20 - a10 * a22;
+        const float c20 = a10 * a21 - a11 * a20;
+
+        const float det = a00 * c00 + a01 * c10 + a02 * c20;
+        if (det == 0.0f) {
+            return false;
+        }
+        const float invDet = 1.0f / det;
+
+        out.m[0][0] = c00 * invDet;
+        out.m[0][1] = (a02 * a21 - a01 * a22) * invDet;
+        out.m[0][2] = (a01 * a12 - a02 * a11) * invDet;
+        out.m[1][0] = c10 * invDet;
+        out.m[1][1] = (a00 * a22 - a02 * a20) * invDet;
+        out.m[1][2] = (a02 * a10 - a00 * a12) * invDet;
+        out.m[2][0] = c20 * invDet;
+        out.m[2][1] = (a01 * a20 - a00 * a21) * invDet;
+        out.m[2][2] = (a00 * a11 - a01 * a10) * invDet;
+        return true;
+    }
+#pragma endregion
 };
@@ -0,0 +1,137 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Minimal 4- and 8-wide float wrappers used by vec4, vec3x8 and mat4.
+// Picks AVX / SSE intrinsics when the compiler targets them and falls back
+// to plain loops otherwise, so the math types compile everywhere.
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MATH_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define MATH_USE_AVX 1
+#include <immintrin.h>
+#endif
+
+namespace simd {
+
+// 8 floats. One AVX register, two SSE registers, or a plain array.
+struct float8 {
+#if defined(MATH_USE_AVX)
+    __m256 v;
+#elif defined(MATH_USE_SSE)
+    __m128 lo, hi;
+#else
+    float v[8];
+#endif
+};
+
+#if defined(MATH_USE_AVX)
+inline float8 set1(float s) { return { _mm256_set1_ps(s) }; }
+inline float8 load(const float* p) { return { _mm256_loadu_ps(p) }; }
+inline void store(float* p, float8 a) { _mm256_storeu_ps(p, a.v); }
+inline float8 operator+(float8 a, float8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+inline float8 operator-(float8 a, float8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+inline float8 operator*(float8 a, float8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+inline float8 operator/(float8 a, float8 b) { return { _mm256_div_ps(a.v, b.v) }; }
+inline float8 sqrt(float8 a) { return { _mm256_sqrt_ps(a.v) }; }
+inline float8 rsqrtEstimate(float8 a) { return { _mm256_rsqrt_ps(a.v) }; }
+// Lanes where a > 0 keep value, others become 0
+inline float8 keepWherePositive(float8 value, float8 a) {
+    return { _mm256_and_ps(value.v, _mm256_cmp_ps(a.v, _mm256_setzero_ps(), _CMP_GT_OQ)) };
+}
+inline float8 min(float8 a, float8 b) { return { _mm256_min_ps(a.v, b.v) }; }
+inline float8 max(float8 a, float8 b) { return { _mm256_max_ps(a.v, b.v) }; }
+// Comparisons give lane masks (all bits set = true) for select/movemask
+inline float8 lessThan(float8 a, float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+inline float8 lessEqual(float8 a, float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+inline float8 operator&(float8 a, float8 b) { return { _mm256_and_ps(a.v, b.v) }; }
+inline float8 operator|(float8 a, float8 b) { return { _mm256_or_ps(a.v, b.v) }; }
+// a & ~b
+inline float8 andNot(float8 a, float8 b) { return { _mm256_andnot_ps(b.v, a.v) }; }
+// mask ? a : b, per lane
+inline float8 select(float8 mask, float8 a, float8 b) { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+// Bit i set if lane i of the mask is true
+inline int movemask(float8 mask) { return _mm256_movemask_ps(mask.v); }
+#elif defined(MATH_USE_SSE)
+inline float8 set1(float s) { return { _mm_set1_ps(s), _mm_set1_ps(s) }; }
+inline float8 load(const float* p) { return { _mm_loadu_ps(p), _mm_loadu_ps(p + 4) }; }
+inline void store(float* p, float8 a) { _mm_storeu_ps(p, a.lo); _mm_storeu_ps(p + 4, a.hi); }
+inline float8 operator+(float8 a, float8 b) { return { _mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi) }; }
+inline float8 operator-(float8 a, float8 b) { return { _mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi) }; }
+inline float8 operator*(float8 a, float8 b) { return { _mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi) }; }
+inline float8 operator/(float8 a, float8 b) { return { _mm_div_ps(a.lo, b.lo), _mm_div_ps(a.hi, b.hi) }; }
+inline float8 sqrt(float8 a) { return { _mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi) }; }
+inline float8 rsqrtEstimate(float8 a) { return { _mm_rsqrt_ps(a.lo), _mm_rsqrt_ps(a.hi) }; }
+inline float8 keepWherePositive(float8 value, float8 a) {
+    const __m128 zero = _mm_setzero_ps();
+    return { _mm_and_ps(value.lo, _mm_cmpgt_ps(a.lo, zero)), _mm_and_ps(value.hi, _mm_cmpgt_ps(a.hi, zero)) };
+}
+inline float8 min(float8 a, float8 b) { return { _mm_min_ps(a.lo, b.lo), _mm_min_ps(a.hi, b.hi) }; }
+inline float8 max(float8 a, float8 b) { return { _mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi) }; }
+inline float8 lessThan(float8 a, float8 b) { return { _mm_cmplt_ps(a.lo, b.lo), _mm_cmplt_ps(a.hi, b.hi) }; }
+inline float8 lessEqual(float8 a, float8 b) { return { _mm_cmple_ps(a.lo, b.lo), _mm_cmple_ps(a.hi, b.hi) }; }
+inline float8 operator&(float8 a, float8 b) { return { _mm_and_ps(a.lo, b.lo), _mm_and_ps(a.hi, b.hi) }; }
+inline float8 operator|(float8 a, float8 b) { return { _mm_or_ps(a.lo, b.lo), _mm_or_ps(a.hi, b.hi) }; }
+inline float8 andNot(float8 a, float8 b) { return { _mm_andnot_ps(b.lo, a.lo), _mm_andnot_ps(b.hi, a.hi) }; }
+inline float8 select(float8 mask, float8 a, float8 b) {
+    return { _mm_or_ps(_mm_and_ps(mask.lo, a.lo), _mm_andnot_ps(mask.lo, b.lo)),
+             _mm_or_ps(_mm_and_ps(mask.hi, a.hi), _mm_andnot_ps(mask.hi, b.hi)) };
+}
+inline int movemask(float8 mask) { return _mm_movemask_ps(mask.lo) | (_mm_movemask_ps(mask.hi) << 4); }
+#else
+inline float8 set1(float s) { float8 r; for (int i = 0; i < 8; i++) r.v[i] = s; return r; }
+inline float8 load(const float* p) { float8 r; for (int i = 0; i < 8; i++) r.v[i] = p[i]; return r; }
+inline void store(float* p, float8 a) { for (int i = 0; i < 8; i++) p[i] = a.v[i]; }
+inline float8 operator+(float8 a, float8 b) { for (int i = 0; i < 8; i++) a.v[i] += b.v[i]; return a; }
+inline float8 operator-(float8 a, float8 b) { for (int i = 0; i < 8; i++) a.v[i] -= b.v[i]; return a; }
+inline float8 operator*(float8 a, float8 b) { for (int i = 0; i < 8; i++) a.v[i] *= b.v[i]; return a; }
+inline float8 operator/(float8 a, float8 b) { for (int i = 0; i < 8; i++) a.v[i] /= b.v[i]; return a; }
+inline float8 sqrt(float8 a) { for (int i = 0; i < 8; i++) a.v[i] = std::sqrt(a.v[i]); return a; }
+inline float8 rsqrtEstimate(float8 a) { for (int i = 0; i < 8; i++) a.v[i] = 1.0f / std::sqrt(a.v[i]); return a; }
+inline float8 keepWherePositive(float8 value, float8 a) {
+    for (int i = 0; i < 8; i++) value.v[i] = (a.v[i] > 0.0f) ? value.v[i] : 0.0f;
+    return value;
+}
+inline float8 min(float8 a, float8 b) { for (int i = 0; i < 8; i++) a.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i]; return a; }
+inline float8 max(float8 a, float8 b) { for (int i = 0; i < 8; i++) a.v[i] = b.v[i] > a.v[i] ? b.v[i] : a.v[i]; return a; }
+// Masks hold all-ones / all-zero bit patterns, like the SIMD versions
+inline float maskLane(bool b) { uint32_t u = b ? 0xFFFFFFFFu : 0u; float f; std::memcpy(&f, &u, 4); return f; }
+inline uint32_t laneBits(float f) { uint32_t u; std::memcpy(&u, &f, 4); return u; }
+inline float8 lessThan(float8 a, float8 b) { for (int i = 0; i < 8; i++) a.v[i] = maskLane(a.v[i] < b.v[i]); return a; }
+inline float8 lessEqual(float8 a, float8 b) { for (int i = 0; i < 8; i++) a.v[i] = maskLane(a.v[i] <= b.v[i]); return a; }
+inline float8 operator&(float8 a, float8 b) {
+    for (int i = 0; i < 8; i++) { const uint32_t u = laneBits(a.v[i]) & laneBits(b.v[i]); std::memcpy(&a.v[i], &u, 4); }
+    return a;
+}
+inline float8 operator|(float8 a, float8 b) {
+    for (int i = 0; i < 8; i++) { const uint32_t u = laneBits(a.v[i]) | laneBits(b.v[i]); std::memcpy(&a.v[i], &u, 4); }
+    return a;
+}
+inline float8 andNot(float8 a, float8 b) {
+    for (int i = 0; i < 8; i++) { const uint32_t u = laneBits(a.v[i]) & ~laneBits(b.v[i]); std::memcpy(&a.v[i], &u, 4); }
+    return a;
+}
+inline float8 select(float8 mask, float8 a, float8 b) {
+    for (int i = 0; i < 8; i++) a.v[i] = (laneBits(mask.v[i]) >> 31) ? a.v[i] : b.v[i];
+    return a;
+}
+inline int movemask(float8 mask) {
+    int bits = 0;
+    for (int i = 0; i < 8; i++) bits |= int(laneBits(mask.v[i]) >> 31) << i;
+    return bits;
+}
+#endif
+
+// 1/sqrt(a) from the hardware estimate (~12 bits) refined by one
+// Newton-Raphson step (~22 bits). Much cheaper than sqrt + divide.
+inline float8 rsqrt(float8 a) {
+    const float8 y = rsqrtEstimate(a);
+    return y * (set1(1.5f) - set1(0.5f) * a * y * y);
+}
+
+} // namespace simd
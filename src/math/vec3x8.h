@@ -0,0 +1,116 @@
+#pragma once
+#include "mat4.h"
+#include "simd.h"
+#include "vec3.h"
+
+// Eight vec3s in structure-of-arrays form: x, y and z each fill one 8-wide
+// register (AVX) or a pair of SSE registers. Meant for batch work - lighting,
+// culling, transforming vertex streams - where scalar vec3 leaves most of the
+// SIMD width idle. Lane i corresponds to the i-th vector loaded.
+class vec3x8 {
+#pragma region DATA
+public:
+    simd::float8 x, y, z;
+#pragma endregion
+
+#pragma region CONSTRUCTORS
+public:
+    vec3x8() : vec3x8(vec3()) {}
+
+    // Broadcast one vector to all lanes
+    explicit vec3x8(const vec3& v) : x(simd::set1(v.x)), y(simd::set1(v.y)), z(simd::set1(v.z)) {}
+
+    vec3x8(simd::float8 x, simd::float8 y, simd::float8 z) : x(x), y(y), z(z) {}
+
+    // Gather 8 consecutive vec3s (array-of-structs) into SoA form
+    static vec3x8 load(const vec3* src) {
+        alignas(32) float xs[8], ys[8], zs[8];
+        for (int i = 0; i < 8; i++) {
+            xs[i] = src[i].x;
+            ys[i] = src[i].y;
+            zs[i] = src[i].z;
+        }
+        return vec3x8(simd::load(xs), simd::load(ys), simd::load(zs));
+    }
+
+    // Load from separate x/y/z streams (8 floats each)
+    static vec3x8 loadSoA(const float* xs, const float* ys, const float* zs) {
+        return vec3x8(simd::load(xs), simd::load(ys), simd::load(zs));
+    }
+#pragma endregion
+
+#pragma region OPERATORS
+public:
+    vec3x8 operator+(const vec3x8& o) const { return vec3x8(x + o.x, y + o.y, z + o.z); }
+    vec3x8 operator-(const vec3x8& o) const { return vec3x8(x - o.x, y - o.y, z - o.z); }
+    vec3x8 operator*(simd::float8 s) const { return vec3x8(x * s, y * s, z * s); }
+    vec3x8 operator*(float s) const { return *this * simd::set1(s); }
+#pragma endregion
+
+#pragma region FUNCTIONS
+public:
+    // Scatter back to 8 consecutive vec3s
+    void store(vec3* dst) const {
+        alignas(32) float xs[8], ys[8], zs[8];
+        simd::store(xs, x);
+        simd::store(ys, y);
+        simd::store(zs, z);
+        for (int i = 0; i < 8; i++) {
+            dst[i] = vec3(xs[i], ys[i], zs[i]);
+        }
+    }
+
+    void storeSoA(float* xs, float* ys, float* zs) const {
+        simd::store(xs, x);
+        simd::store(ys, y);
+        simd::store(zs, z);
+    }
+
+    simd::float8 dot(const vec3x8& o) const {
+        return x * o.x + y * o.y + z * o.z;
+    }
+
+    vec3x8 cross(const vec3x8& o) const {
+        return vec3x8(
+            y * o.z - z * o.y,
+            z * o.x - x * o.z,
+            x * o.y - y * o.x
+        );
+    }
+
+    simd::float8 lengthsquared() const {
+        return dot(*this);
+    }
+
+    simd::float8 length() const {
+        return simd::sqrt(lengthsquared());
+    }
+
+    // rsqrt + one Newton step (~22 bits). Zero-length lanes become zero.
+    vec3x8 normalized() const {
+        const simd::float8 len2 = lengthsquared();
+        return *this * simd::keepWherePositive(simd::rsqrt(len2), len2);
+    }
+
+    // Transform 8 points (w=1) with perspective divide, like mat4 * vec3
+    vec3x8 transformPoint(const mat4& m) const {
+        using simd::set1;
+        const simd::float8 tx = x * set1(m.m[0][0]) + y * set1(m.m[1][0]) + z * set1(m.m[2][0]) + set1(m.m[3][0]);
+        const simd::float8 ty = x * set1(m.m[0][1]) + y * set1(m.m[1][1]) + z * set1(m.m[2][1]) + set1(m.m[3][1]);
+        const simd::float8 tz = x * set1(m.m[0][2]) + y * set1(m.m[1][2]) + z * set1(m.m[2][2]) + set1(m.m[3][2]);
+        const simd::float8 tw = x * set1(m.m[0][3]) + y * set1(m.m[1][3]) + z * set1(m.m[2][3]) + set1(m.m[3][3]);
+        const simd::float8 invW = set1(1.0f) / tw;
+        return vec3x8(tx * invW, ty * invW, tz * invW);
+    }
+
+    // Transform 8 directions (w=0): no translation, no divide
+    vec3x8 transformDirection(const mat4& m) const {
+        using simd::set1;
+        return vec3x8(
+            x * set1(m.m[0][0]) + y * set1(m.m[1][0]) + z * set1(m.m[2][0]),
+            x * set1(m.m[0][1]) + y * set1(m.m[1][1]) + z * set1(m.m[2][1]),
+            x * set1(m.m[0][2]) + y * set1(m.m[1][2]) + z * set1(m.m[2][2])
+        );
+    }
+#pragma endregion
+};
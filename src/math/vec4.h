@@ -0,0 +1,114 @@
+#pragma once
+#include "simd.h"
+#include "vec3.h"
+#include <cmath>
+
+// 4-component vector, 16-byte aligned so it maps onto one SSE register.
+// Used for homogeneous coordinates (w) and 4-wide math; vec3 stays the
+// plain scalar type for everything else.
+class alignas(16) vec4 {
+#pragma region DATA
+public:
+    float x, y, z, w;
+#pragma endregion
+
+#pragma region CONSTRUCTORS
+public:
+    vec4() : vec4(0.f) {}
+    explicit vec4(float s) : x(s), y(s), z(s), w(s) {}
+    vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    vec4(const vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+
+#ifdef MATH_USE_SSE
+    explicit vec4(__m128 v) { _mm_store_ps(&x, v); }
+    __m128 simd() const { return _mm_load_ps(&x); }
+#endif
+#pragma endregion
+
+#pragma region OPERATORS
+public:
+#ifdef MATH_USE_SSE
+    vec4 operator+(const vec4& other) const { return vec4(_mm_add_ps(simd(), other.simd())); }
+    vec4 operator-(const vec4& other) const { return vec4(_mm_sub_ps(simd(), other.simd())); }
+    vec4 operator*(const vec4& other) const { return vec4(_mm_mul_ps(simd(), other.simd())); }
+    vec4 operator*(float s) const { return vec4(_mm_mul_ps(simd(), _mm_set1_ps(s))); }
+    vec4 operator/(float s) const { return vec4(_mm_div_ps(simd(), _mm_set1_ps(s))); }
+    vec4 operator-() const { return vec4(_mm_sub_ps(_mm_setzero_ps(), simd())); }
+#else
+    vec4 operator+(const vec4& o) const { return vec4(x + o.x, y + o.y, z + o.z, w + o.w); }
+    vec4 operator-(const vec4& o) const { return vec4(x - o.x, y - o.y, z - o.z, w - o.w); }
+    vec4 operator*(const vec4& o) const { return vec4(x * o.x, y * o.y, z * o.z, w * o.w); }
+    vec4 operator*(float s) const { return vec4(x * s, y * s, z * s, w * s); }
+    vec4 operator/(float s) const { return vec4(x / s, y / s, z / s, w / s); }
+    vec4 operator-() const { return vec4(-x, -y, -z, -w); }
+#endif
+
+    vec4& operator+=(const vec4& other) { return *this = *this + other; }
+    vec4& operator-=(const vec4& other) { return *this = *this - other; }
+    vec4& operator*=(float s) { return *this = *this * s; }
+    vec4& operator/=(float s) { return *this = *this / s; }
+#pragma endregion
+
+#pragma region FUNCTIONS
+public:
+    float dot(const vec4& other) const {
+#ifdef MATH_USE_SSE
+        __m128 m = _mm_mul_ps(simd(), other.simd());
+        // Horizontal add: (x+z, y+w) then (x+z)+(y+w)
+        m = _mm_add_ps(m, _mm_movehl_ps(m, m));
+        m = _mm_add_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(m);
+#else
+        return x * other.x + y * other.y + z * other.z + w * other.w;
+#endif
+    }
+
+    inline float lengthsquared() const {
+        return dot(*this);
+    }
+
+    inline float length() const {
+        return std::sqrt(lengthsquared());
+    }
+
+    // Exact normalize (sqrt + divide); zero vector stays zero
+    vec4 normalized() const {
+        const float len = length();
+        if (len > 0.f) {
+            return *this / len;
+        }
+        return vec4();
+    }
+
+    // Approximate normalize: rsqrt estimate + one Newton step (~22 bits)
+    vec4 normalizedFast() const {
+        const float len2 = lengthsquared();
+        if (!(len2 > 0.f)) {
+            return vec4();
+        }
+#ifdef MATH_USE_SSE
+        const __m128 l = _mm_set1_ps(len2);
+        const __m128 e = _mm_rsqrt_ps(l);
+        const __m128 r = _mm_mul_ps(e, _mm_sub_ps(_mm_set1_ps(1.5f),
+                                    _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), l), _mm_mul_ps(e, e))));
+        return vec4(_mm_mul_ps(simd(), r));
+#else
+        return *this / std::sqrt(len2);
+#endif
+    }
+
+    vec3 xyz() const {
+        return vec3(x, y, z);
+    }
+
+    // Perspective divide
+    vec3 projected() const {
+        return vec3(x / w, y / w, z / w);
+    }
+#pragma endregion
+};
+
+// Non-member operators for scalar multiplication (reversed order)
+inline vec4 operator*(float s, const vec4& v) {
+    return v * s;
+}
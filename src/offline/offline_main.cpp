@@ -0,0 +1,295 @@
+#include "offline/poster_renderer.h"
+#include "offline/render_farm.h"
+#include "core/thread_pool.h"
+#include "image/tga_export.h"
+#include "image/video_writer.h"
+#include "math/mat4.h"
+#include "raytrace/bvh.h"
+#include "raytrace/ray_caster.h"
+#include "rendering/command_buffer.h"
+#include "scene/mesh.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Headless batch renderer: renders an animation sequence across several
+// worker processes and writes one TGA per frame, or streams all frames as
+// video (--video file.y4m, --video - for stdout, --raw for raw BGRA).
+// --poster renders a single still of any size as a set of TGA tiles plus a
+// manifest, with bounded memory (see PosterRenderer).
+// --raycast renders one still of a box field with the BVH ray caster
+// (shadows and --ao N occlusion rays per pixel, 0 for none).
+//
+// Usage: renderer_offline [--size WxH] [--frames N] [--workers N]
+//                         [--tile N] [--batch N] [--out pattern]
+//                         [--video path] [--raw] [--fps N]
+//        renderer_offline --poster WxH [--poster-tile N] [--poster-out prefix]
+//        renderer_offline --raycast out.tga [--size WxH] [--ao N]
+
+namespace {
+    // Demo scene: the gradient background with a spinning shaded triangle
+    void recordScene(CommandBuffer& commands, int width, int height, int frameIndex) {
+        commands.setLayer(0);
+        commands.fillWithGradient();
+
+        const float angle = frameIndex * 0.05f;
+        const mat4 transform = mat4::translate(width / 2.0f, height / 2.0f, 0.0f) *
+                               mat4::rotateZ(angle) *
+                               mat4::scale(height / 3.0f);
+        const vec3 a = transform * vec3(0.0f, -1.0f, 0.0f);
+        const vec3 b = transform * vec3(0.866f, 0.5f, 0.0f);
+        const vec3 c = transform * vec3(-0.866f, 0.5f, 0.0f);
+
+        commands.setLayer(1);
+        commands.fillTriangle(a.x, a.y, b.x, b.y, c.x, c.y, color::red(), color::green(), color::blue());
+    }
+
+    // Poster scene: a field of shaded cubes seen in perspective. projection
+    // already covers just this tile, so vertices go straight to tile pixels.
+    void recordPosterScene(CommandBuffer& commands, const mat4& projection, int tileWidth, int tileHeight) {
+        commands.clear(makeColor(16, 16, 24));
+
+        const mat4 view = mat4::lookAt(vec3(0.0f, 9.0f, 16.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+        const mat4 viewProjection = projection * view;
+
+        // Back to front, so nearer cubes are drawn over farther ones
+        constexpr int GRID = 12;
+        for (int gz = 0; gz < GRID; gz++) {
+            for (int gx = 0; gx < GRID; gx++) {
+                const float x = (gx - GRID / 2 + 0.5f) * 2.0f;
+                const float z = (gz - GRID / 2 + 0.5f) * 2.0f;
+                const mat4 model = mat4::translate(x, 0.0f, z) * mat4::rotateY(0.4f * (gx + gz)) * mat4::scale(0.6f);
+                const mat4 mvp = viewProjection * model;
+
+                vec3 screen[8];
+                bool visible = true;
+                for (int i = 0; i < 8; i++) {
+                    const vec4 clip = mvp * vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f);
+                    if (clip.w <= 0.1f) {
+                        visible = false;
+                        break;
+                    }
+                    screen[i] = vec3((clip.x / clip.w + 1.0f) * 0.5f * tileWidth,
+                                     (1.0f - clip.y / clip.w) * 0.5f * tileHeight, 0.0f);
+                }
+                if (!visible) continue;
+
+                // Faces as corner indices, counter-clockwise seen from outside
+                static const int faces[6][4] = {
+                    {0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}
+                };
+                const color shade(0.3f + 0.7f * gx / GRID, 0.4f, 0.3f + 0.7f * gz / GRID, 1.0f);
+                for (int f = 0; f < 6; f++) {
+                    const vec3& p0 = screen[faces[f][0]];
+                    const vec3& p1 = screen[faces[f][1]];
+                    const vec3& p2 = screen[faces[f][2]];
+                    const vec3& p3 = screen[faces[f][3]];
+                    // Screen y points down, so front faces wind clockwise here
+                    const float area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+                    if (area >= 0.0f) continue;
+                    const color light = shade * (0.5f + 0.1f * f);
+                    commands.fillTriangle(p0.x, p0.y, p1.x, p1.y, p2.x, p2.y, light, light, shade);
+                    commands.fillTriangle(p0.x, p0.y, p2.x, p2.y, p3.x, p3.y, light, shade, light);
+                }
+            }
+        }
+    }
+
+    // Ray cast scene: the poster's cube field as a mesh, on a ground plane
+    void buildRayCastScene(Mesh& mesh) {
+        mesh.appendQuad(mat4::translate(0.0f, -0.6f, 0.0f) * mat4::scale(16.0f), color(0.75f, 0.75f, 0.7f));
+        constexpr int GRID = 12;
+        for (int gz = 0; gz < GRID; gz++) {
+            for (int gx = 0; gx < GRID; gx++) {
+                const float x = (gx - GRID / 2 + 0.5f) * 2.0f;
+                const float z = (gz - GRID / 2 + 0.5f) * 2.0f;
+                const mat4 model = mat4::translate(x, 0.0f, z) * mat4::rotateY(0.4f * (gx + gz)) * mat4::scale(0.6f);
+                mesh.appendBox(model, color(0.3f + 0.7f * gx / GRID, 0.4f, 0.3f + 0.7f * gz / GRID, 1.0f));
+            }
+        }
+    }
+
+    int renderRayCast(const std::string& path, int width, int height, int aoSamples) {
+        Mesh mesh;
+        buildRayCastScene(mesh);
+
+        const auto start = std::chrono::steady_clock::now();
+        BVH bvh;
+        bvh.build(mesh);
+        const auto built = std::chrono::steady_clock::now();
+
+        ThreadPool pool;
+        Framebuffer frame(width, height);
+        RayCaster caster(bvh);
+        RayCastSettings settings;
+        settings.aoSamples = aoSamples;
+        const mat4 view = mat4::lookAt(vec3(0.0f, 9.0f, 16.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+        const mat4 projection = mat4::perspective(0.8f, float(width) / height, 0.5f, 100.0f);
+        caster.render(frame, view, projection, settings, &pool);
+        const auto rendered = std::chrono::steady_clock::now();
+
+        const RayCastStats& stats = caster.getStats();
+        const double buildMs = std::chrono::duration<double, std::milli>(built - start).count();
+        const double renderMs = std::chrono::duration<double, std::milli>(rendered - built).count();
+        const uint64_t rays = stats.primaryRays + stats.shadowRays + stats.occlusionRays;
+        std::cout << "Ray cast " << width << "x" << height << ": " << mesh.triangleCount() << " triangles, BVH "
+                  << bvh.getNodes().size() << " nodes in " << buildMs << " ms, " << rays << " rays in "
+                  << renderMs << " ms on " << pool.getThreadCount() << " threads" << std::endl;
+        return FramebufferToTGA(frame).write_tga_file(path, false, true) ? 0 : 1;
+    }
+
+    int renderPoster(const PosterConfig& config) {
+        ThreadPool pool;
+        PosterRenderer poster(config);
+        const mat4 projection = mat4::perspective(0.8f, float(config.width) / config.height, 0.5f, 100.0f);
+        const bool ok = poster.render(projection,
+            [](Framebuffer& tile, const mat4& tileProjection, const RasterRect&) {
+                CommandBuffer commands;
+                recordPosterScene(commands, tileProjection, tile.getWidth(), tile.getHeight());
+                commands.execute(tile);
+            },
+            &pool);
+
+        const PosterStats& stats = poster.getStats();
+        std::cout << "Poster " << config.width << "x" << config.height << ": " << stats.tilesWritten
+                  << " tiles in " << stats.bandsCompleted << " bands, " << stats.bytesWritten / (1024 * 1024)
+                  << " MiB, manifest " << poster.manifestFilename() << std::endl;
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    RenderFarmConfig config;
+    int frameCount = 1;
+    std::string outputPattern = "frame_%04d.tga";
+    std::string videoPath;
+    VideoFormat videoFormat = VideoFormat::Y4M;
+    int framesPerSecond = 30;
+    PosterConfig posterConfig;
+    bool poster = false;
+    std::string rayCastPath;
+    int aoSamples = 4;
+
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--size") && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &config.width, &config.height) != 2) {
+                std::cerr << "Bad --size, expected WxH\n";
+                return 1;
+            }
+        } else if (!std::strcmp(argv[i], "--frames") && hasValue) {
+            frameCount = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--workers") && hasValue) {
+            config.workerCount = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--tile") && hasValue) {
+            config.tileSize = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--batch") && hasValue) {
+            config.framesPerBatch = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--out") && hasValue) {
+            outputPattern = argv[++i];
+        } else if (!std::strcmp(argv[i], "--video") && hasValue) {
+            videoPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--raw")) {
+            videoFormat = VideoFormat::RawBGRA;
+        } else if (!std::strcmp(argv[i], "--fps") && hasValue) {
+            framesPerSecond = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--poster") && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &posterConfig.width, &posterConfig.height) != 2) {
+                std::cerr << "Bad --poster, expected WxH\n";
+                return 1;
+            }
+            poster = true;
+        } else if (!std::strcmp(argv[i], "--poster-tile") && hasValue) {
+            posterConfig.tileWidth = posterConfig.tileHeight = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--poster-out") && hasValue) {
+            posterConfig.outputPrefix = argv[++i];
+        } else if (!std::strcmp(argv[i], "--raycast") && hasValue) {
+            rayCastPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--ao") && hasValue) {
+            aoSamples = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    if (poster) {
+        if (posterConfig.width <= 0 || posterConfig.height <= 0 || posterConfig.tileWidth <= 0) {
+            std::cerr << "Nothing to render\n";
+            return 1;
+        }
+        try {
+            return renderPoster(posterConfig);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!rayCastPath.empty()) {
+        if (config.width <= 0 || config.height <= 0) {
+            std::cerr << "Nothing to render\n";
+            return 1;
+        }
+        return renderRayCast(rayCastPath, config.width, config.height, aoSamples);
+    }
+
+    if (config.width <= 0 || config.height <= 0 || frameCount <= 0) {
+        std::cerr << "Nothing to render\n";
+        return 1;
+    }
+    if (!videoPath.empty() && framesPerSecond <= 0) {
+        std::cerr << "Bad --fps, expected a positive frame rate\n";
+        return 1;
+    }
+
+    try {
+        // Streaming output: frames go straight into the video sink instead
+        // of one file each. The pool only converts color in the coordinator.
+        std::unique_ptr<ThreadPool> conversionPool;
+        std::unique_ptr<VideoWriter> video;
+        FrameDoneFn onFrame = RenderFarm::writeTGA(outputPattern);
+        if (!videoPath.empty()) {
+            conversionPool = std::make_unique<ThreadPool>();
+            video = std::make_unique<VideoWriter>(videoPath, config.width, config.height,
+                                                  videoFormat, framesPerSecond, conversionPool.get());
+            if (!video->isOpen()) {
+                std::cerr << "Can't open video output " << videoPath << "\n";
+                return 1;
+            }
+            onFrame = [&video](const Framebuffer& frame, int) { return video->writeFrame(frame); };
+        }
+
+        // Each worker process renders its tiles one at a time into its own
+        // (forked) copy of this buffer; reset() keeps the memory between tiles
+        CommandBuffer commands;
+        RenderFarm farm(config);
+        const bool ok = farm.renderSequence(0, frameCount,
+            [&](Framebuffer& frame, const RasterRect& tile, int frameIndex) {
+                commands.reset();
+                recordScene(commands, frame.getWidth(), frame.getHeight(), frameIndex);
+                for (uint32_t index : commands.getSortedOrder()) {
+                    ExecuteCommand(commands.getCommands()[index], frame, tile);
+                }
+            },
+            onFrame);
+        const bool videoOk = !video || video->close();
+
+        // Progress goes to stderr when the video itself is on stdout
+        const RenderFarmStats& stats = farm.getStats();
+        std::ostream& report = (videoPath == "-") ? std::cerr : std::cout;
+        report << "Frames: " << stats.framesCompleted << ", tiles: " << stats.tilesRendered
+                  << ", worker crashes: " << stats.workerCrashes
+                  << ", restarts: " << stats.workerRestarts << std::endl;
+        return (ok && videoOk) ? 0 : 1;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
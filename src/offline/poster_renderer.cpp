@@ -0,0 +1,123 @@
+#include "poster_renderer.h"
+#include "core/thread_pool.h"
+#include "image/tga_export.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+    constexpr int MAX_TGA_SIZE = 65535;
+}
+
+mat4 SubProjection(const mat4& projection, int width, int height, const RasterRect& region) {
+    // Region edges in NDC of the full image (y up)
+    const float left = static_cast<float>(2.0 * region.minX / width - 1.0);
+    const float right = static_cast<float>(2.0 * region.maxX / width - 1.0);
+    const float top = static_cast<float>(1.0 - 2.0 * region.minY / height);
+    const float bottom = static_cast<float>(1.0 - 2.0 * region.maxY / height);
+    // ortho() with near = 1, far = -1 is a pure x/y scale + offset: it maps
+    // [left, right] x [bottom, top] onto [-1, 1] and keeps z as is. Applied
+    // after the projection it commutes with the perspective divide.
+    return mat4::ortho(left, right, bottom, top, 1.0f, -1.0f) * projection;
+}
+
+PosterRenderer::PosterRenderer(const PosterConfig& config) : config(config) {
+    this->config.tileWidth = std::clamp(config.tileWidth, 1, MAX_TGA_SIZE);
+    this->config.tileHeight = std::clamp(config.tileHeight, 1, MAX_TGA_SIZE);
+}
+
+std::string PosterRenderer::tileFilename(int row, int column) const {
+    std::vector<char> name(config.outputPrefix.size() + 32);
+    std::snprintf(name.data(), name.size(), "%s_r%04d_c%04d.tga", config.outputPrefix.c_str(), row, column);
+    return name.data();
+}
+
+bool PosterRenderer::render(const mat4& projection, const PosterTileFn& renderTile, ThreadPool* pool) {
+    stats = PosterStats();
+    if (config.width <= 0 || config.height <= 0) {
+        return false;
+    }
+
+    std::ofstream manifest(manifestFilename());
+    if (!manifest.is_open()) {
+        std::cerr << "can't open file " << manifestFilename() << "\n";
+        return false;
+    }
+    const int columns = getColumns();
+    const int rows = getRows();
+    manifest << "poster " << config.width << " " << config.height << "\n"
+             << "tiles " << config.tileWidth << " " << config.tileHeight << " "
+             << columns << " " << rows << "\n";
+
+    // One reusable tile buffer per worker: the only pixel memory alive
+    const int threadCount = pool ? pool->getThreadCount() : 1;
+    std::vector<std::unique_ptr<Framebuffer>> targets(threadCount);
+
+    std::vector<RasterRect> regions(columns);
+    std::vector<uint64_t> fileSizes(columns);
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            RasterRect& region = regions[column];
+            region.minX = column * config.tileWidth;
+            region.minY = row * config.tileHeight;
+            region.maxX = std::min(config.width, region.minX + config.tileWidth);
+            region.maxY = std::min(config.height, region.minY + config.tileHeight);
+        }
+
+        std::atomic<bool> failed{false};
+        auto renderColumn = [&](int column, int worker) {
+            const RasterRect& region = regions[column];
+            const int w = region.maxX - region.minX;
+            const int h = region.maxY - region.minY;
+            std::unique_ptr<Framebuffer>& target = targets[worker];
+            if (!target) {
+                target = std::make_unique<Framebuffer>(w, h);
+            } else {
+                target->resize(w, h);
+            }
+
+            renderTile(*target, SubProjection(projection, config.width, config.height, region), region);
+
+            // Framebuffer rows are top-down, so write with a top-left origin
+            const std::string filename = tileFilename(row, column);
+            if (!FramebufferToTGA(*target).write_tga_file(filename, false, config.rle)) {
+                failed = true;
+                return;
+            }
+            std::error_code error;
+            const uintmax_t size = std::filesystem::file_size(filename, error);
+            fileSizes[column] = error ? 0 : size;
+        };
+
+        if (pool) {
+            pool->parallelFor(columns, renderColumn);
+        } else {
+            for (int column = 0; column < columns; column++) {
+                renderColumn(column, 0);
+            }
+        }
+        if (failed) {
+            return false;
+        }
+
+        // The band is on disk: record it before starting the next one
+        for (int column = 0; column < columns; column++) {
+            const RasterRect& region = regions[column];
+            manifest << "tile " << row << " " << column << " " << region.minX << " " << region.minY << " "
+                     << region.maxX - region.minX << " " << region.maxY - region.minY << " "
+                     << std::filesystem::path(tileFilename(row, column)).filename().string() << "\n";
+            stats.bytesWritten += fileSizes[column];
+        }
+        manifest.flush();
+        stats.tilesWritten += columns;
+        stats.bandsCompleted++;
+    }
+
+    manifest << "complete\n";
+    return manifest.good();
+}
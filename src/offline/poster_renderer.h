@@ -0,0 +1,67 @@
+#pragma once
+
+#include "core/framebuffer.h"
+#include "math/mat4.h"
+#include "rendering/rasterizer.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+class ThreadPool;
+
+struct PosterConfig {
+    int width = 20000;
+    int height = 20000;
+    int tileWidth = 2048;       // Output tile size, at most 65535 (TGA limit)
+    int tileHeight = 2048;
+    std::string outputPrefix = "poster";  // Writes <prefix>_rRRRR_cCCCC.tga and <prefix>.manifest
+    bool rle = true;
+};
+
+struct PosterStats {
+    int bandsCompleted = 0;
+    int tilesWritten = 0;
+    uint64_t bytesWritten = 0;
+};
+
+// Renders one output tile. tile is tile-local (pixel (0, 0) is the tile's
+// top-left corner), projection is the caller's full-image projection
+// narrowed to this tile (see SubProjection), region is where the tile sits in
+// the full image. Must overwrite every pixel of the tile.
+using PosterTileFn = std::function<void(Framebuffer& tile, const mat4& projection, const RasterRect& region)>;
+
+// Projection for a sub-rectangle of a width x height image.
+// Maps the region's part of NDC back onto [-1, 1], so rendering with the
+// result into a region-sized target gives exactly the region's pixels of a
+// full-size render. Depth is left untouched. Framebuffer rows are top-down:
+// region row 0 is NDC y = +1.
+mat4 SubProjection(const mat4& projection, int width, int height, const RasterRect& region);
+
+// Out-of-core renderer for images too large for memory (or for one TGA).
+//
+// The image is rendered one band (a row of output tiles) at a time; each tile
+// gets its own sub-projection and is written as a separate TGA as soon as it
+// is done. Only one tile per worker thread is ever resident, so peak memory
+// is about threads * tileWidth * tileHeight * 8 bytes however large the
+// poster is. A text manifest lists every tile with its position so the set
+// can be stitched (or loaded lazily) later; it is appended band by band and
+// ends with a "complete" line once every tile has been written.
+class PosterRenderer {
+public:
+    explicit PosterRenderer(const PosterConfig& config);
+
+    // Tiles of a band are spread over pool (may be null)
+    bool render(const mat4& projection, const PosterTileFn& renderTile, ThreadPool* pool = nullptr);
+
+    const PosterStats& getStats() const { return stats; }
+    int getColumns() const { return (config.width + config.tileWidth - 1) / config.tileWidth; }
+    int getRows() const { return (config.height + config.tileHeight - 1) / config.tileHeight; }
+
+    // File name of the tile at (row, column)
+    std::string tileFilename(int row, int column) const;
+    std::string manifestFilename() const { return config.outputPrefix + ".manifest"; }
+
+private:
+    PosterConfig config;
+    PosterStats stats;
+};
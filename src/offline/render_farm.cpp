@@ -0,0 +1,220 @@
+#include "render_farm.h"
+#include "offline/shared_memory.h"
+#include "image/tga_export.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <new>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+    // Job states. Values >= 0 mean "running on worker slot N".
+    constexpr int32_t JOB_PENDING = -1;
+    constexpr int32_t JOB_DONE = -2;
+
+    // Atomics shared between processes must not hide a lock inside
+    static_assert(std::atomic<int32_t>::is_always_lock_free, "need address-free atomics");
+
+    // Lives at the start of the shared region; jobCount state words follow it
+    struct JobTable {
+        std::atomic<int32_t> cursor;    // Next never-claimed job
+        int32_t jobCount;
+
+        std::atomic<int32_t>* states() { return reinterpret_cast<std::atomic<int32_t>*>(this + 1); }
+    };
+
+    size_t jobTableSize(int jobCount) {
+        const size_t bytes = sizeof(JobTable) + sizeof(std::atomic<int32_t>) * jobCount;
+        return (bytes + 63) & ~size_t(63);  // Keep pixels cache-line aligned
+    }
+
+    bool tryClaim(JobTable* table, int job, int32_t slot) {
+        int32_t expected = JOB_PENDING;
+        return table->states()[job].compare_exchange_strong(expected, slot, std::memory_order_acq_rel);
+    }
+
+    // First hand out jobs in order; once those run out, sweep for jobs that
+    // were put back after a crash.
+    int claimJob(JobTable* table, int32_t slot) {
+        while (true) {
+            const int job = table->cursor.fetch_add(1, std::memory_order_relaxed);
+            if (job >= table->jobCount) break;
+            if (tryClaim(table, job, slot)) return job;
+        }
+        for (int job = 0; job < table->jobCount; job++) {
+            if (table->states()[job].load(std::memory_order_relaxed) == JOB_PENDING &&
+                tryClaim(table, job, slot)) {
+                return job;
+            }
+        }
+        return -1;
+    }
+}
+
+RenderFarm::RenderFarm(const RenderFarmConfig& config) : config(config) {
+    if (this->config.workerCount <= 0) {
+        this->config.workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    this->config.tileSize = std::max(this->config.tileSize, 8);
+    this->config.framesPerBatch = std::max(this->config.framesPerBatch, 1);
+}
+
+bool RenderFarm::renderSequence(int firstFrame, int frameCount, const TileRenderFn& renderTile, const FrameDoneFn& onFrame) {
+    stats = {};
+    for (int frame = firstFrame; frame < firstFrame + frameCount; frame += config.framesPerBatch) {
+        const int batch = std::min(config.framesPerBatch, firstFrame + frameCount - frame);
+        if (!renderBatch(frame, batch, renderTile, onFrame)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RenderFarm::renderFrame(int frameIndex, const TileRenderFn& renderTile, Framebuffer& out) {
+    return renderSequence(frameIndex, 1, renderTile, [&out](const Framebuffer& frame, int) {
+        out = Framebuffer(frame.getWidth(), frame.getHeight());
+        std::copy(frame.data(), frame.data() + frame.getWidth() * frame.getHeight(), out.data());
+        return true;
+    });
+}
+
+bool RenderFarm::renderBatch(int firstFrame, int frameCount, const TileRenderFn& renderTile, const FrameDoneFn& onFrame) {
+    const int width = config.width;
+    const int height = config.height;
+    const int tileSize = config.tileSize;
+    const int tilesX = (width + tileSize - 1) / tileSize;
+    const int tilesY = (height + tileSize - 1) / tileSize;
+    const int tilesPerFrame = tilesX * tilesY;
+    const int jobCount = tilesPerFrame * frameCount;
+
+    const size_t tableBytes = jobTableSize(jobCount);
+    const size_t frameBytes = size_t(width) * height * sizeof(uint32_t);
+    SharedMemoryRegion region(tableBytes + frameBytes * frameCount);
+
+    JobTable* table = static_cast<JobTable*>(region.data());
+    new (&table->cursor) std::atomic<int32_t>(0);
+    table->jobCount = jobCount;
+    for (int job = 0; job < jobCount; job++) {
+        new (&table->states()[job]) std::atomic<int32_t>(JOB_PENDING);
+    }
+    uint32_t* framePixels = reinterpret_cast<uint32_t*>(static_cast<char*>(region.data()) + tableBytes);
+
+    // Flush buffered output so children don't print it a second time
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+
+    auto spawnWorker = [&](int32_t slot) -> pid_t {
+        pid_t pid = fork();
+        if (pid != 0) {
+            return pid;  // Coordinator (or -1 on failure)
+        }
+
+        // Worker process: claim and render until the table is drained
+        int exitCode = 0;
+        try {
+            int job;
+            while ((job = claimJob(table, slot)) >= 0) {
+                const int frameInBatch = job / tilesPerFrame;
+                const int tile = job % tilesPerFrame;
+                const RasterRect rect = {
+                    (tile % tilesX) * tileSize,
+                    (tile / tilesX) * tileSize,
+                    std::min(width, (tile % tilesX + 1) * tileSize),
+                    std::min(height, (tile / tilesX + 1) * tileSize)
+                };
+                Framebuffer frame(width, height, framePixels + size_t(frameInBatch) * width * height);
+                renderTile(frame, rect, firstFrame + frameInBatch);
+                table->states()[job].store(JOB_DONE, std::memory_order_release);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Render worker " << slot << " failed: " << e.what() << std::endl;
+            exitCode = 1;
+        }
+        // Skip atexit handlers and destructors that belong to the coordinator
+        _exit(exitCode);
+    };
+
+    std::map<pid_t, int32_t> workers;
+    for (int32_t slot = 0; slot < config.workerCount && slot < jobCount; slot++) {
+        pid_t pid = spawnWorker(slot);
+        if (pid < 0) {
+            std::cerr << "fork failed for render worker " << slot << "\n";
+            continue;
+        }
+        workers[pid] = slot;
+    }
+
+    int restarts = 0;
+    while (!workers.empty()) {
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            break;  // No children left (or interrupted beyond repair)
+        }
+        auto it = workers.find(pid);
+        if (it == workers.end()) {
+            continue;  // Not one of ours
+        }
+        const int32_t slot = it->second;
+        workers.erase(it);
+
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            continue;
+        }
+
+        // Crashed: put its unfinished job(s) back and replace it
+        stats.workerCrashes++;
+        for (int job = 0; job < jobCount; job++) {
+            int32_t expected = slot;
+            table->states()[job].compare_exchange_strong(expected, JOB_PENDING);
+        }
+        if (WIFSIGNALED(status)) {
+            std::cerr << "Render worker " << slot << " killed by signal " << WTERMSIG(status) << "\n";
+        }
+        if (restarts < config.maxRestarts) {
+            pid_t replacement = spawnWorker(slot);
+            if (replacement > 0) {
+                workers[replacement] = slot;
+                restarts++;
+                stats.workerRestarts++;
+            }
+        }
+    }
+
+    int unfinished = 0;
+    for (int job = 0; job < jobCount; job++) {
+        if (table->states()[job].load(std::memory_order_acquire) != JOB_DONE) {
+            unfinished++;
+        }
+    }
+    stats.tilesRendered += jobCount - unfinished;
+    if (unfinished > 0) {
+        std::cerr << "Render farm gave up with " << unfinished << " unfinished tiles\n";
+        return false;
+    }
+
+    for (int i = 0; i < frameCount; i++) {
+        const Framebuffer frame(width, height, framePixels + size_t(i) * width * height);
+        if (!onFrame(frame, firstFrame + i)) {
+            return false;
+        }
+        stats.framesCompleted++;
+    }
+    return true;
+}
+
+FrameDoneFn RenderFarm::writeTGA(const std::string& pattern, bool rle) {
+    return [pattern, rle](const Framebuffer& frame, int frameIndex) {
+        std::vector<char> name(pattern.size() + 32);
+        std::snprintf(name.data(), name.size(), pattern.c_str(), frameIndex);
+        // Framebuffer rows are top-down, so write with a top-left origin
+        return FramebufferToTGA(frame).write_tga_file(name.data(), false, rle);
+    };
+}
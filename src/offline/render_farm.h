@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core/framebuffer.h"
+#include "rendering/rasterizer.h"
+#include <functional>
+#include <string>
+
+struct RenderFarmConfig {
+    int width = 1920;
+    int height = 1080;
+    int tileSize = 128;
+    int workerCount = 0;        // Worker processes, 0 = one per hardware thread
+    int framesPerBatch = 4;     // Frames resident in shared memory at once
+    int maxRestarts = 8;        // Crashed workers replaced per batch before giving up
+};
+
+struct RenderFarmStats {
+    int framesCompleted = 0;
+    int tilesRendered = 0;
+    int workerCrashes = 0;
+    int workerRestarts = 0;
+};
+
+// Renders one tile of one frame inside a worker process. Must overwrite every
+// pixel of the tile: if a worker dies mid-tile the tile is simply rendered
+// again by another worker.
+using TileRenderFn = std::function<void(Framebuffer& frame, const RasterRect& tile, int frameIndex)>;
+
+// Called in the coordinator for each finished frame, in order.
+// Return false to abort the sequence.
+using FrameDoneFn = std::function<bool(const Framebuffer& frame, int frameIndex)>;
+
+// Multi-process offline renderer.
+//
+// Frames live in a shared memory region that worker processes (fork()ed from
+// the coordinator) render into directly - no pixels are copied between
+// processes. Work is split into (frame, tile) jobs that workers claim from a
+// lock-free job table in the same region. The coordinator reaps workers,
+// puts the jobs of a crashed worker back in the queue and starts a
+// replacement. POSIX only.
+//
+// Workers are plain fork()ed copies of the coordinator: the tile callback
+// must not rely on threads (e.g. a ThreadPool) created before the fork.
+class RenderFarm {
+public:
+    explicit RenderFarm(const RenderFarmConfig& config);
+
+    // Render frames [firstFrame, firstFrame + frameCount).
+    // Returns false if a frame could not be completed or onFrame aborted.
+    bool renderSequence(int firstFrame, int frameCount, const TileRenderFn& renderTile, const FrameDoneFn& onFrame);
+
+    // Convenience: render a single frame and return a copy of it
+    bool renderFrame(int frameIndex, const TileRenderFn& renderTile, Framebuffer& out);
+
+    const RenderFarmStats& getStats() const { return stats; }
+
+    // FrameDoneFn that writes each frame as a TGA file. pattern is a printf
+    // format taking the frame index, e.g. "frame_%04d.tga".
+    static FrameDoneFn writeTGA(const std::string& pattern, bool rle = true);
+
+private:
+    bool renderBatch(int firstFrame, int frameCount, const TileRenderFn& renderTile, const FrameDoneFn& onFrame);
+
+    RenderFarmConfig config;
+    RenderFarmStats stats;
+};
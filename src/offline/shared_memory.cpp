@@ -0,0 +1,49 @@
+#include "shared_memory.h"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+    int createBackingObject() {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+        const int memfd = memfd_create("diy-engine-shm", MFD_CLOEXEC);
+        if (memfd >= 0) {
+            return memfd;
+        }
+#endif
+        // Portable fallback: unique name, unlinked right away
+        static std::atomic<int> counter{0};
+        const std::string name = "/diy-engine-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            shm_unlink(name.c_str());
+        }
+        return fd;
+    }
+}
+
+SharedMemoryRegion::SharedMemoryRegion(size_t size) : length(size) {
+    descriptor = createBackingObject();
+    if (descriptor < 0) {
+        throw std::runtime_error("Failed to create shared memory object");
+    }
+
+    if (ftruncate(descriptor, static_cast<off_t>(length)) != 0) {
+        close(descriptor);
+        throw std::runtime_error("Failed to size shared memory object");
+    }
+
+    mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (mapping == MAP_FAILED) {
+        close(descriptor);
+        throw std::runtime_error("Failed to map shared memory");
+    }
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+    if (mapping && mapping != MAP_FAILED) munmap(mapping, length);
+    if (descriptor >= 0) close(descriptor);
+}
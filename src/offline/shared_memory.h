@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+// Anonymous shared memory that survives fork().
+// Backed by memfd_create() on Linux and by an immediately unlinked POSIX
+// shm_open() object elsewhere, so nothing is left behind in /dev/shm if the
+// process dies. Throws std::runtime_error on failure.
+class SharedMemoryRegion {
+public:
+    explicit SharedMemoryRegion(size_t size);
+    ~SharedMemoryRegion();
+
+    // Prevent copying
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    void* data() const { return mapping; }
+    size_t size() const { return length; }
+
+    // File descriptor of the backing object (can be handed to exec'd children)
+    int fd() const { return descriptor; }
+
+private:
+    void* mapping = nullptr;
+    size_t length = 0;
+    int descriptor = -1;
+};
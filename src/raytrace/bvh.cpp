@@ -0,0 +1,490 @@
+#include "bvh.h"
+#include "scene/mesh.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+    constexpr int MAX_BINS = 32;
+    constexpr int MAX_SAH_LEAF = 16;      // Largest leaf SAH may choose over splitting
+    constexpr int DEPTH_LIMIT = 48;       // Past this, split at the median to stay within the traversal stack
+    constexpr float TRAVERSAL_COST = 1.0f; // Relative to one triangle test
+    constexpr float MIN_DIRECTION = 1e-20f;
+    constexpr float MISS = std::numeric_limits<float>::infinity();
+
+    struct Box {
+        float lo[3] = { 1e30f, 1e30f, 1e30f };
+        float hi[3] = { -1e30f, -1e30f, -1e30f };
+
+        void grow(const vec3& p) {
+            lo[0] = std::min(lo[0], p.x); hi[0] = std::max(hi[0], p.x);
+            lo[1] = std::min(lo[1], p.y); hi[1] = std::max(hi[1], p.y);
+            lo[2] = std::min(lo[2], p.z); hi[2] = std::max(hi[2], p.z);
+        }
+        void grow(const Box& b) {
+            for (int a = 0; a < 3; a++) {
+                lo[a] = std::min(lo[a], b.lo[a]);
+                hi[a] = std::max(hi[a], b.hi[a]);
+            }
+        }
+        float area() const {
+            const float dx = hi[0] - lo[0], dy = hi[1] - lo[1], dz = hi[2] - lo[2];
+            return (dx < 0.0f) ? 0.0f : dx * dy + dy * dz + dz * dx;
+        }
+        float center(int axis) const { return 0.5f * (lo[axis] + hi[axis]); }
+    };
+
+    Box triangleBox(const Mesh& mesh, uint32_t triangle) {
+        const uint32_t* index = &mesh.indices[size_t(triangle) * 3];
+        Box box;
+        box.grow(mesh.positions[index[0]]);
+        box.grow(mesh.positions[index[1]]);
+        box.grow(mesh.positions[index[2]]);
+        return box;
+    }
+
+    void storeBox(BVHNode& node, const Box& box) {
+        std::memcpy(node.boundsMin, box.lo, sizeof(box.lo));
+        std::memcpy(node.boundsMax, box.hi, sizeof(box.hi));
+    }
+
+    // 1 / d with zero components nudged, so slab distances stay finite
+    float safeInverse(float d) {
+        return 1.0f / (d < 0.0f ? std::min(d, -MIN_DIRECTION) : std::max(d, MIN_DIRECTION));
+    }
+
+    simd::float8 safeInverse(simd::float8 d) {
+        const simd::float8 zero = simd::set1(0.0f);
+        const simd::float8 nudged = simd::select(simd::lessThan(d, zero),
+                                                 simd::min(d, simd::set1(-MIN_DIRECTION)),
+                                                 simd::max(d, simd::set1(MIN_DIRECTION)));
+        return simd::set1(1.0f) / nudged;
+    }
+
+    // Lane mask with all bits set where bit i of mask is set
+    simd::float8 laneMask(int mask) {
+        alignas(32) uint32_t bits[8];
+        alignas(32) float lanes[8];
+        for (int i = 0; i < 8; i++) {
+            bits[i] = (mask >> i & 1) ? 0xFFFFFFFFu : 0u;
+        }
+        std::memcpy(lanes, bits, sizeof(bits));
+        return simd::load(lanes);
+    }
+
+    // Möller-Trumbore. True for a hit with t in (0, tMax), filling t, u, v.
+    bool intersectTriangle(const vec3& origin, const vec3& direction, const vec3& p0, const vec3& p1,
+                           const vec3& p2, float tMax, float& t, float& u, float& v) {
+        const vec3 e1 = p1 - p0;
+        const vec3 e2 = p2 - p0;
+        const vec3 p = direction.cross(e2);
+        const float det = e1.dot(p);
+        if (det == 0.0f) return false;
+        const float invDet = 1.0f / det;
+        const vec3 s = origin - p0;
+        const float hitU = s.dot(p) * invDet;
+        if (hitU < 0.0f || hitU > 1.0f) return false;
+        const vec3 q = s.cross(e1);
+        const float hitV = direction.dot(q) * invDet;
+        if (hitV < 0.0f || hitU + hitV > 1.0f) return false;
+        const float hitT = e2.dot(q) * invDet;
+        if (!(hitT > 0.0f && hitT < tMax)) return false;
+        t = hitT;
+        u = hitU;
+        v = hitV;
+        return true;
+    }
+
+    // Entry distance of the ray into node's box, or MISS if it misses before
+    // tMax. Hit distances are always finite (invDir is), even for tMax = inf.
+    float intersectBox(const BVHNode& node, const float origin[3], const float invDir[3], float tMax) {
+        float tNear = 0.0f;
+        float tFar = tMax;
+        for (int a = 0; a < 3; a++) {
+            const float t0 = (node.boundsMin[a] - origin[a]) * invDir[a];
+            const float t1 = (node.boundsMax[a] - origin[a]) * invDir[a];
+            tNear = std::max(tNear, std::min(t0, t1));
+            tFar = std::min(tFar, std::max(t0, t1));
+        }
+        return tNear <= tFar ? tNear : MISS;
+    }
+
+    // Slab test for 8 rays; originScaled = origin * invDir
+    int intersectBox8(const BVHNode& node, const vec3x8& invDir, const vec3x8& originScaled, simd::float8 tMax) {
+        using simd::set1;
+        const simd::float8 x0 = set1(node.boundsMin[0]) * invDir.x - originScaled.x;
+        const simd::float8 x1 = set1(node.boundsMax[0]) * invDir.x - originScaled.x;
+        const simd::float8 y0 = set1(node.boundsMin[1]) * invDir.y - originScaled.y;
+        const simd::float8 y1 = set1(node.boundsMax[1]) * invDir.y - originScaled.y;
+        const simd::float8 z0 = set1(node.boundsMin[2]) * invDir.z - originScaled.z;
+        const simd::float8 z1 = set1(node.boundsMax[2]) * invDir.z - originScaled.z;
+        const simd::float8 tNear = simd::max(simd::max(simd::min(x0, x1), simd::min(y0, y1)),
+                                             simd::max(simd::min(z0, z1), set1(0.0f)));
+        const simd::float8 tFar = simd::min(simd::min(simd::max(x0, x1), simd::max(y0, y1)),
+                                            simd::min(simd::max(z0, z1), tMax));
+        return simd::movemask(simd::lessEqual(tNear, tFar));
+    }
+
+    // One triangle against 8 rays; returns the lane mask of hits nearer than tMax
+    simd::float8 intersectTriangle8(const RayPacket8& packet, const vec3& p0, const vec3& p1, const vec3& p2,
+                                    simd::float8 tMax, simd::float8& t, simd::float8& u, simd::float8& v) {
+        const simd::float8 zero = simd::set1(0.0f);
+        const simd::float8 one = simd::set1(1.0f);
+        const vec3x8 e1(p1 - p0);
+        const vec3x8 e2(p2 - p0);
+        const vec3x8 p = packet.direction.cross(e2);
+        // A zero determinant gives inf/NaN below, which fails every comparison
+        const simd::float8 invDet = one / e1.dot(p);
+        const vec3x8 s = packet.origin - vec3x8(p0);
+        u = s.dot(p) * invDet;
+        const vec3x8 q = s.cross(e1);
+        v = packet.direction.dot(q) * invDet;
+        t = e2.dot(q) * invDet;
+        return simd::lessEqual(zero, u) & simd::lessEqual(zero, v) & simd::lessEqual(u + v, one) &
+               simd::lessThan(zero, t) & simd::lessThan(t, tMax);
+    }
+
+    // Child to visit first along the node's split axis, from the sign of one active ray
+    struct DirectionSigns {
+        bool negative[3];
+
+        DirectionSigns(const RayPacket8& packet, int activeMask) {
+            alignas(32) float xs[8], ys[8], zs[8];
+            packet.direction.storeSoA(xs, ys, zs);
+            int lane = 0;
+            while (lane < 7 && !(activeMask >> lane & 1)) lane++;
+            negative[0] = xs[lane] < 0.0f;
+            negative[1] = ys[lane] < 0.0f;
+            negative[2] = zs[lane] < 0.0f;
+        }
+    };
+}
+
+void BVH::build(const Mesh& source, const BVHBuildSettings& settings) {
+    mesh = &source;
+    nodes.clear();
+    depth = 0;
+    const uint32_t triangleCount = static_cast<uint32_t>(source.triangleCount());
+    triangleOrder.resize(triangleCount);
+    std::iota(triangleOrder.begin(), triangleOrder.end(), 0u);
+    if (triangleCount == 0) {
+        return;
+    }
+
+    const int binCount = std::clamp(settings.binCount, 2, MAX_BINS);
+    const uint32_t maxLeafSize = static_cast<uint32_t>(std::clamp(settings.maxLeafSize, 1, MAX_SAH_LEAF));
+
+    std::vector<Box> boxes(triangleCount);
+    for (uint32_t i = 0; i < triangleCount; i++) {
+        boxes[i] = triangleBox(source, i);
+    }
+
+    struct Task {
+        uint32_t node, first, count;
+        int depth;
+    };
+    std::vector<Task> tasks;
+    nodes.reserve(size_t(triangleCount) * 2);
+    nodes.emplace_back();
+    tasks.push_back({ 0, 0, triangleCount, 1 });
+
+    while (!tasks.empty()) {
+        const Task task = tasks.back();
+        tasks.pop_back();
+        depth = std::max(depth, task.depth);
+        uint32_t* order = triangleOrder.data() + task.first;
+
+        Box bounds, centroids;
+        for (uint32_t i = 0; i < task.count; i++) {
+            const Box& b = boxes[order[i]];
+            bounds.grow(b);
+            centroids.grow(vec3(b.center(0), b.center(1), b.center(2)));
+        }
+        storeBox(nodes[task.node], bounds);
+
+        auto makeLeaf = [&] {
+            nodes[task.node].leftOrFirst = task.first;
+            nodes[task.node].count = static_cast<uint16_t>(task.count);
+            nodes[task.node].axis = 0;
+        };
+        if (task.count <= maxLeafSize) {
+            makeLeaf();
+            continue;
+        }
+
+        // Binned SAH over all three axes
+        int bestAxis = -1;
+        int bestBin = 0;
+        float bestCost = 1e30f;
+        if (task.depth < DEPTH_LIMIT) {
+            for (int axis = 0; axis < 3; axis++) {
+                const float extent = centroids.hi[axis] - centroids.lo[axis];
+                if (extent <= 0.0f) continue;
+                const float scale = binCount / extent;
+
+                Box binBoxes[MAX_BINS];
+                uint32_t binCounts[MAX_BINS] = {};
+                for (uint32_t i = 0; i < task.count; i++) {
+                    const Box& b = boxes[order[i]];
+                    const int bin = std::min(binCount - 1, int((b.center(axis) - centroids.lo[axis]) * scale));
+                    binBoxes[bin].grow(b);
+                    binCounts[bin]++;
+                }
+
+                // Right-to-left sweep first, then evaluate each plane going left to right
+                float rightArea[MAX_BINS];
+                uint32_t rightCount[MAX_BINS];
+                Box sweep;
+                uint32_t count = 0;
+                for (int bin = binCount - 1; bin > 0; bin--) {
+                    sweep.grow(binBoxes[bin]);
+                    count += binCounts[bin];
+                    rightArea[bin] = sweep.area();
+                    rightCount[bin] = count;
+                }
+                sweep = Box();
+                count = 0;
+                for (int bin = 0; bin < binCount - 1; bin++) {
+                    sweep.grow(binBoxes[bin]);
+                    count += binCounts[bin];
+                    if (count == 0 || rightCount[bin + 1] == 0) continue;
+                    const float cost = count * sweep.area() + rightCount[bin + 1] * rightArea[bin + 1];
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestBin = bin;
+                    }
+                }
+            }
+        }
+
+        uint32_t leftCount = 0;
+        if (bestAxis >= 0) {
+            const float splitCost = TRAVERSAL_COST + bestCost / std::max(bounds.area(), 1e-30f);
+            if (splitCost >= float(task.count) && task.count <= MAX_SAH_LEAF) {
+                makeLeaf();
+                continue;
+            }
+            const float scale = binCount / (centroids.hi[bestAxis] - centroids.lo[bestAxis]);
+            const float lo = centroids.lo[bestAxis];
+            leftCount = static_cast<uint32_t>(std::partition(order, order + task.count, [&](uint32_t triangle) {
+                return std::min(binCount - 1, int((boxes[triangle].center(bestAxis) - lo) * scale)) <= bestBin;
+            }) - order);
+        }
+        if (leftCount == 0 || leftCount == task.count) {
+            // Coincident centroids, too deep, or SAH found no usable plane: halve along the widest axis
+            if (task.count <= MAX_SAH_LEAF) {
+                makeLeaf();
+                continue;
+            }
+            bestAxis = 0;
+            for (int axis = 1; axis < 3; axis++) {
+                if (centroids.hi[axis] - centroids.lo[axis] > centroids.hi[bestAxis] - centroids.lo[bestAxis]) {
+                    bestAxis = axis;
+                }
+            }
+            leftCount = task.count / 2;
+            std::nth_element(order, order + leftCount, order + task.count, [&](uint32_t a, uint32_t b) {
+                return boxes[a].center(bestAxis) < boxes[b].center(bestAxis);
+            });
+        }
+
+        const uint32_t left = static_cast<uint32_t>(nodes.size());
+        nodes[task.node].leftOrFirst = left;
+        nodes[task.node].count = 0;
+        nodes[task.node].axis = static_cast<uint16_t>(bestAxis);
+        nodes.emplace_back();
+        nodes.emplace_back();
+        tasks.push_back({ left + 1, task.first + leftCount, task.count - leftCount, task.depth + 1 });
+        tasks.push_back({ left, task.first, leftCount, task.depth + 1 });
+    }
+}
+
+void BVH::refit() {
+    // Children always come after their parent, so one reverse pass suffices
+    for (size_t i = nodes.size(); i-- > 0;) {
+        BVHNode& node = nodes[i];
+        Box box;
+        if (node.isLeaf()) {
+            for (uint32_t k = 0; k < node.count; k++) {
+                box.grow(triangleBox(*mesh, triangleOrder[node.leftOrFirst + k]));
+            }
+        } else {
+            for (uint32_t child = node.leftOrFirst; child < node.leftOrFirst + 2; child++) {
+                for (int a = 0; a < 3; a++) {
+                    box.lo[a] = std::min(box.lo[a], nodes[child].boundsMin[a]);
+                    box.hi[a] = std::max(box.hi[a], nodes[child].boundsMax[a]);
+                }
+            }
+        }
+        storeBox(node, box);
+    }
+}
+
+bool BVH::intersect(const vec3& origin, const vec3& direction, RayHit& hit) const {
+    if (nodes.empty()) return false;
+    const float o[3] = { origin.x, origin.y, origin.z };
+    const float invDir[3] = { safeInverse(direction.x), safeInverse(direction.y), safeInverse(direction.z) };
+    const std::vector<vec3>& positions = mesh->positions;
+    bool found = false;
+
+    uint32_t stack[MAX_STACK];
+    int stackSize = 0;
+    if (intersectBox(nodes[0], o, invDir, hit.t) == MISS) return false;
+    uint32_t index = 0;
+    for (;;) {
+        const BVHNode& node = nodes[index];
+        if (node.isLeaf()) {
+            for (uint32_t k = 0; k < node.count; k++) {
+                const uint32_t triangle = triangleOrder[node.leftOrFirst + k];
+                const uint32_t* v = &mesh->indices[size_t(triangle) * 3];
+                float t = 0.0f, u = 0.0f, w = 0.0f;
+                if (intersectTriangle(origin, direction, positions[v[0]], positions[v[1]], positions[v[2]], hit.t, t, u, w)) {
+                    hit.t = t;
+                    hit.u = u;
+                    hit.v = w;
+                    hit.triangle = triangle;
+                    found = true;
+                }
+            }
+        } else {
+            // Visit the nearer child first, keep the other for later
+            uint32_t near = node.leftOrFirst;
+            uint32_t far = near + 1;
+            float tNear = intersectBox(nodes[near], o, invDir, hit.t);
+            float tFar = intersectBox(nodes[far], o, invDir, hit.t);
+            if (tFar < tNear) {
+                std::swap(near, far);
+                std::swap(tNear, tFar);
+            }
+            if (tNear != MISS) {
+                if (tFar != MISS) stack[stackSize++] = far;
+                index = near;
+                continue;
+            }
+        }
+
+        // Pop, skipping nodes that a closer hit has since ruled out
+        for (;;) {
+            if (stackSize == 0) return found;
+            index = stack[--stackSize];
+            if (intersectBox(nodes[index], o, invDir, hit.t) != MISS) break;
+        }
+    }
+}
+
+bool BVH::occluded(const vec3& origin, const vec3& direction, float tMax) const {
+    if (nodes.empty()) return false;
+    const float o[3] = { origin.x, origin.y, origin.z };
+    const float invDir[3] = { safeInverse(direction.x), safeInverse(direction.y), safeInverse(direction.z) };
+    const std::vector<vec3>& positions = mesh->positions;
+
+    uint32_t stack[MAX_STACK];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const BVHNode& node = nodes[stack[--stackSize]];
+        if (intersectBox(node, o, invDir, tMax) == MISS) continue;
+        if (node.isLeaf()) {
+            for (uint32_t k = 0; k < node.count; k++) {
+                const uint32_t* v = &mesh->indices[size_t(triangleOrder[node.leftOrFirst + k]) * 3];
+                float t = 0.0f, u = 0.0f, w = 0.0f;
+                if (intersectTriangle(origin, direction, positions[v[0]], positions[v[1]], positions[v[2]], tMax, t, u, w)) {
+                    return true;
+                }
+            }
+        } else {
+            stack[stackSize++] = node.leftOrFirst + 1;
+            stack[stackSize++] = node.leftOrFirst;
+        }
+    }
+    return false;
+}
+
+void BVH::intersect8(const RayPacket8& packet, PacketHit8& hit, int activeMask) const {
+    for (uint32_t& triangle : hit.triangle) {
+        triangle = RAY_NO_HIT;
+    }
+    hit.u = hit.v = simd::set1(0.0f);
+    // Inactive lanes get a negative limit, so no box or triangle accepts them
+    hit.t = simd::select(laneMask(activeMask), packet.tMax, simd::set1(-1.0f));
+    if (nodes.empty() || !(activeMask & 0xFF)) return;
+
+    const vec3x8 invDir(safeInverse(packet.direction.x), safeInverse(packet.direction.y),
+                        safeInverse(packet.direction.z));
+    const vec3x8 originScaled(packet.origin.x * invDir.x, packet.origin.y * invDir.y, packet.origin.z * invDir.z);
+    const DirectionSigns signs(packet, activeMask);
+    const std::vector<vec3>& positions = mesh->positions;
+
+    uint32_t stack[MAX_STACK];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const BVHNode& node = nodes[stack[--stackSize]];
+        if (!intersectBox8(node, invDir, originScaled, hit.t)) continue;
+
+        if (node.isLeaf()) {
+            for (uint32_t k = 0; k < node.count; k++) {
+                const uint32_t triangle = triangleOrder[node.leftOrFirst + k];
+                const uint32_t* v = &mesh->indices[size_t(triangle) * 3];
+                simd::float8 t, u, w;
+                const simd::float8 mask = intersectTriangle8(packet, positions[v[0]], positions[v[1]],
+                                                             positions[v[2]], hit.t, t, u, w);
+                int bits = simd::movemask(mask);
+                if (!bits) continue;
+                hit.t = simd::select(mask, t, hit.t);
+                hit.u = simd::select(mask, u, hit.u);
+                hit.v = simd::select(mask, w, hit.v);
+                for (int lane = 0; bits; lane++, bits >>= 1) {
+                    if (bits & 1) hit.triangle[lane] = triangle;
+                }
+            }
+        } else {
+            // Far child below near child on the stack
+            const uint32_t near = node.leftOrFirst + (signs.negative[node.axis] ? 1 : 0);
+            stack[stackSize++] = node.leftOrFirst * 2 + 1 - near;
+            stack[stackSize++] = near;
+        }
+    }
+}
+
+int BVH::occluded8(const RayPacket8& packet, int activeMask) const {
+    activeMask &= 0xFF;
+    if (nodes.empty() || !activeMask) return 0;
+
+    const vec3x8 invDir(safeInverse(packet.direction.x), safeInverse(packet.direction.y),
+                        safeInverse(packet.direction.z));
+    const vec3x8 originScaled(packet.origin.x * invDir.x, packet.origin.y * invDir.y, packet.origin.z * invDir.z);
+    const std::vector<vec3>& positions = mesh->positions;
+
+    // Lanes drop out (limit goes negative) as soon as they are blocked
+    simd::float8 tMax = simd::select(laneMask(activeMask), packet.tMax, simd::set1(-1.0f));
+    int blocked = 0;
+
+    uint32_t stack[MAX_STACK];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const BVHNode& node = nodes[stack[--stackSize]];
+        if (!intersectBox8(node, invDir, originScaled, tMax)) continue;
+
+        if (node.isLeaf()) {
+            for (uint32_t k = 0; k < node.count; k++) {
+                const uint32_t* v = &mesh->indices[size_t(triangleOrder[node.leftOrFirst + k]) * 3];
+                simd::float8 t, u, w;
+                const simd::float8 mask = intersectTriangle8(packet, positions[v[0]], positions[v[1]],
+                                                             positions[v[2]], tMax, t, u, w);
+                const int bits = simd::movemask(mask);
+                if (!bits) continue;
+                blocked |= bits;
+                if (blocked == activeMask) return blocked;
+                tMax = simd::select(mask, simd::set1(-1.0f), tMax);
+            }
+        } else {
+            stack[stackSize++] = node.leftOrFirst + 1;
+            stack[stackSize++] = node.leftOrFirst;
+        }
+    }
+    return blocked;
+}
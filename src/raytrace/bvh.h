@@ -0,0 +1,97 @@
+#pragma once
+
+#include "math/simd.h"
+#include "math/vec3.h"
+#include "math/vec3x8.h"
+#include <cstdint>
+#include <vector>
+
+struct Mesh;
+
+// 32 bytes, two per cache line
+struct BVHNode {
+    float boundsMin[3];
+    uint32_t leftOrFirst;  // Inner: left child (right is left + 1). Leaf: first entry in the triangle order.
+    float boundsMax[3];
+    uint16_t count;        // Triangles in a leaf, 0 for inner nodes
+    uint16_t axis;         // Split axis of an inner node, picks which child to visit first
+
+    bool isLeaf() const { return count > 0; }
+};
+
+constexpr uint32_t RAY_NO_HIT = 0xFFFFFFFFu;
+
+struct RayHit {
+    float t = 1e30f;                // In: farthest distance accepted. Out: hit distance.
+    float u = 0.0f, v = 0.0f;       // Barycentrics of vertices 1 and 2
+    uint32_t triangle = RAY_NO_HIT;
+};
+
+// Eight rays traced together. Traversal pays off when they are coherent
+// (primary rays from a pixel block, shadow rays toward one light), but any
+// set of rays is correct.
+struct RayPacket8 {
+    vec3x8 origin;
+    vec3x8 direction;              // Need not be normalized; t is in units of direction
+    simd::float8 tMax = simd::set1(1e30f);
+};
+
+struct PacketHit8 {
+    simd::float8 t, u, v;
+    alignas(32) uint32_t triangle[8];
+};
+
+struct BVHBuildSettings {
+    int binCount = 16;      // SAH candidate planes per axis, at most 32
+    int maxLeafSize = 4;    // Preferred leaf size; SAH may stop earlier
+};
+
+// Bounding volume hierarchy over a Mesh for ray queries.
+//
+// Built top-down with the binned surface area heuristic. Nodes live in one
+// flat array with siblings adjacent and every child stored after its parent,
+// so refit() is a single reverse pass. Leaves refer to triangles through an
+// index permutation; vertex data is always read from the Mesh itself, which
+// must outlive the BVH.
+//
+// Animated meshes: move vertices in place and call refit(). The topology is
+// kept, so a refit tree is as correct as a rebuilt one but slows down once
+// triangles have travelled far from where they were built; rebuild then.
+//
+// Queries are const and safe to run from any number of threads.
+class BVH {
+public:
+    BVH() = default;
+
+    void build(const Mesh& mesh, const BVHBuildSettings& settings = BVHBuildSettings());
+
+    // Recompute bounds after the mesh's positions changed (same triangles)
+    void refit();
+
+    bool empty() const { return nodes.empty(); }
+    const Mesh* getMesh() const { return mesh; }
+    const std::vector<BVHNode>& getNodes() const { return nodes; }
+    int getDepth() const { return depth; }
+
+    // Closest hit along origin + t * direction with t in (0, hit.t).
+    // Returns true and fills hit if something was found.
+    bool intersect(const vec3& origin, const vec3& direction, RayHit& hit) const;
+
+    // Any hit with t in (0, tMax)
+    bool occluded(const vec3& origin, const vec3& direction, float tMax) const;
+
+    // Closest hits for the lanes set in activeMask (bit i = lane i).
+    // Inactive lanes and misses come back with triangle = RAY_NO_HIT.
+    void intersect8(const RayPacket8& packet, PacketHit8& hit, int activeMask = 0xFF) const;
+
+    // Bit i is set if active lane i hits anything before its tMax
+    int occluded8(const RayPacket8& packet, int activeMask = 0xFF) const;
+
+private:
+    static constexpr int MAX_STACK = 128;  // Build depth stays below this (median splits past DEPTH_LIMIT)
+
+    const Mesh* mesh = nullptr;
+    std::vector<BVHNode> nodes;
+    std::vector<uint32_t> triangleOrder;  // Leaf ranges index this, entries are mesh triangles
+    int depth = 0;
+};
@@ -0,0 +1,227 @@
+#include "ray_caster.h"
+#include "bvh.h"
+#include "core/thread_pool.h"
+#include "scene/mesh.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace {
+    constexpr int PACKET_WIDTH = 4;
+    constexpr int PACKET_HEIGHT = 2;
+
+    uint32_t hash(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    float toUnit(uint32_t bits) {
+        return (bits >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Cosine-weighted direction around unit normal n (Duff et al. basis)
+    vec3 cosineDirection(const vec3& n, float u1, float u2) {
+        const float sign = std::copysign(1.0f, n.z);
+        const float a = -1.0f / (sign + n.z);
+        const float b = n.x * n.y * a;
+        const vec3 tangent(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x);
+        const vec3 bitangent(b, sign + n.y * n.y * a, -n.y);
+        const float r = std::sqrt(u1);
+        const float phi = 6.2831853f * u2;
+        return tangent * (r * std::cos(phi)) + bitangent * (r * std::sin(phi)) + n * std::sqrt(std::max(0.0f, 1.0f - u1));
+    }
+
+    int laneCount(int mask) {
+        int count = 0;
+        for (; mask; mask &= mask - 1) count++;
+        return count;
+    }
+
+    struct TileJob {
+        const BVH& bvh;
+        const Mesh& mesh;
+        Framebuffer& framebuffer;
+        const mat4& inverseViewProjection;
+        const RayCastSettings& settings;
+        vec3 toLight;
+        int tileSize;
+        RayCastStats stats;
+
+        void renderPacket(int px, int py);
+        void renderTile(int tileX, int tileY) {
+            const int x0 = tileX * tileSize;
+            const int y0 = tileY * tileSize;
+            const int x1 = std::min(x0 + tileSize, framebuffer.getWidth());
+            const int y1 = std::min(y0 + tileSize, framebuffer.getHeight());
+            for (int y = y0; y < y1; y += PACKET_HEIGHT) {
+                for (int x = x0; x < x1; x += PACKET_WIDTH) {
+                    renderPacket(x, y);
+                }
+            }
+        }
+    };
+
+    void TileJob::renderPacket(int px, int py) {
+        const int width = framebuffer.getWidth();
+        const int height = framebuffer.getHeight();
+
+        // Lane i covers pixel (px + i % 4, py + i / 4)
+        alignas(32) float ndcX[8], ndcY[8], nearZ[8], farZ[8];
+        int active = 0;
+        for (int i = 0; i < 8; i++) {
+            const int x = px + i % PACKET_WIDTH;
+            const int y = py + i / PACKET_WIDTH;
+            if (x < width && y < height) active |= 1 << i;
+            ndcX[i] = (x + 0.5f) * 2.0f / width - 1.0f;
+            ndcY[i] = 1.0f - (y + 0.5f) * 2.0f / height;
+            nearZ[i] = -1.0f;
+            farZ[i] = 1.0f;
+        }
+
+        // Unnormalized near-to-far directions: t = 1 is the far plane
+        RayPacket8 primary;
+        primary.origin = vec3x8::loadSoA(ndcX, ndcY, nearZ).transformPoint(inverseViewProjection);
+        primary.direction = vec3x8::loadSoA(ndcX, ndcY, farZ).transformPoint(inverseViewProjection) - primary.origin;
+        primary.tMax = simd::set1(1.0f);
+
+        PacketHit8 hit;
+        bvh.intersect8(primary, hit, active);
+        stats.primaryRays += laneCount(active);
+
+        alignas(32) float ts[8], us[8], vs[8];
+        simd::store(ts, hit.t);
+        simd::store(us, hit.u);
+        simd::store(vs, hit.v);
+        vec3 origins[8], directions[8];
+        primary.origin.store(origins);
+        primary.direction.store(directions);
+
+        // Surface attributes per lane
+        vec3 positions[8], normals[8];
+        color albedo[8];
+        int hitMask = 0;
+        for (int i = 0; i < 8; i++) {
+            positions[i] = vec3();
+            normals[i] = vec3(0.0f, 1.0f, 0.0f);
+            if (hit.triangle[i] == RAY_NO_HIT) continue;
+            hitMask |= 1 << i;
+            const uint32_t* v = &mesh.indices[size_t(hit.triangle[i]) * 3];
+            const vec3& p0 = mesh.positions[v[0]];
+            vec3 n = (mesh.positions[v[1]] - p0).cross(mesh.positions[v[2]] - p0).normalized();
+            if (n.dot(directions[i]) > 0.0f) n = -n;  // Shade both sides, facing the viewer
+            const float w = 1.0f - us[i] - vs[i];
+            albedo[i] = mesh.colors[v[0]] * w + mesh.colors[v[1]] * us[i] + mesh.colors[v[2]] * vs[i];
+            normals[i] = n;
+            positions[i] = origins[i] + directions[i] * ts[i] + n * settings.rayOffset;
+        }
+        stats.hits += laneCount(hitMask);
+
+        float lighting[8];
+        if (settings.shading == RayCastShading::Unlit) {
+            std::fill(lighting, lighting + 8, 1.0f);
+        } else {
+            float direct[8] = {};
+            int litMask = 0;
+            for (int i = 0; i < 8; i++) {
+                if (!(hitMask >> i & 1)) continue;
+                direct[i] = std::max(0.0f, normals[i].dot(toLight));
+                if (direct[i] > 0.0f) litMask |= 1 << i;
+            }
+
+            if (settings.shadows && litMask) {
+                RayPacket8 shadow;
+                shadow.origin = vec3x8::load(positions);
+                shadow.direction = vec3x8(toLight);
+                const int blocked = bvh.occluded8(shadow, litMask);
+                stats.shadowRays += laneCount(litMask);
+                for (int i = 0; i < 8; i++) {
+                    if (blocked >> i & 1) direct[i] = 0.0f;
+                }
+            }
+
+            float ambientOcclusion[8];
+            std::fill(ambientOcclusion, ambientOcclusion + 8, 1.0f);
+            if (settings.aoSamples > 0 && hitMask) {
+                int open[8] = {};
+                RayPacket8 occlusion;
+                occlusion.origin = vec3x8::load(positions);
+                occlusion.tMax = simd::set1(settings.aoRadius);
+                for (int s = 0; s < settings.aoSamples; s++) {
+                    vec3 sampleDirections[8];
+                    for (int i = 0; i < 8; i++) {
+                        const uint32_t pixel = uint32_t(py + i / PACKET_WIDTH) * uint32_t(width) + uint32_t(px + i % PACKET_WIDTH);
+                        const uint32_t h = hash(pixel * 0x9e3779b9u ^ hash(settings.seed * 64u + uint32_t(s)));
+                        sampleDirections[i] = cosineDirection(normals[i], toUnit(h), toUnit(hash(h)));
+                    }
+                    occlusion.direction = vec3x8::load(sampleDirections);
+                    const int blocked = bvh.occluded8(occlusion, hitMask);
+                    for (int i = 0; i < 8; i++) {
+                        open[i] += !(blocked >> i & 1);
+                    }
+                }
+                stats.occlusionRays += uint64_t(laneCount(hitMask)) * settings.aoSamples;
+                for (int i = 0; i < 8; i++) {
+                    ambientOcclusion[i] = float(open[i]) / settings.aoSamples;
+                }
+            }
+
+            for (int i = 0; i < 8; i++) {
+                lighting[i] = settings.ambient * ambientOcclusion[i] + (1.0f - settings.ambient) * direct[i];
+            }
+        }
+
+        const uint32_t background = settings.background.toUint32();
+        for (int i = 0; i < 8; i++) {
+            if (!(active >> i & 1)) continue;
+            uint32_t& pixel = framebuffer.data()[size_t(py + i / PACKET_WIDTH) * width + px + i % PACKET_WIDTH];
+            if (hitMask >> i & 1) {
+                color c = albedo[i] * lighting[i];
+                c.a = 1.0f;
+                pixel = c.toUint32();
+            } else {
+                pixel = background;
+            }
+        }
+    }
+}
+
+void RayCaster::render(Framebuffer& framebuffer, const mat4& view, const mat4& projection,
+                       const RayCastSettings& settings, ThreadPool* pool) {
+    stats = RayCastStats();
+    if (bvh.empty()) {
+        framebuffer.clear(settings.background.toUint32());
+        return;
+    }
+
+    const mat4 inverseViewProjection = (projection * view).inverse();
+    const int tileSize = std::max(8, (settings.tileSize + 7) / 8 * 8);
+    const int tilesX = (framebuffer.getWidth() + tileSize - 1) / tileSize;
+    const int tilesY = (framebuffer.getHeight() + tileSize - 1) / tileSize;
+    const vec3 toLight = (-settings.lightDirection).normalized();
+
+    std::atomic<uint64_t> primaryRays{0}, shadowRays{0}, occlusionRays{0}, hits{0};
+    auto tileJob = [&](int tile, int) {
+        TileJob job{ bvh, *bvh.getMesh(), framebuffer, inverseViewProjection, settings, toLight, tileSize, RayCastStats() };
+        job.renderTile(tile % tilesX, tile / tilesX);
+        primaryRays.fetch_add(job.stats.primaryRays, std::memory_order_relaxed);
+        shadowRays.fetch_add(job.stats.shadowRays, std::memory_order_relaxed);
+        occlusionRays.fetch_add(job.stats.occlusionRays, std::memory_order_relaxed);
+        hits.fetch_add(job.stats.hits, std::memory_order_relaxed);
+    };
+    if (pool) {
+        pool->parallelFor(tilesX * tilesY, tileJob);
+    } else {
+        for (int tile = 0; tile < tilesX * tilesY; tile++) {
+            tileJob(tile, 0);
+        }
+    }
+
+    stats.primaryRays = primaryRays.load();
+    stats.shadowRays = shadowRays.load();
+    stats.occlusionRays = occlusionRays.load();
+    stats.hits = hits.load();
+}
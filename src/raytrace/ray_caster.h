@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/framebuffer.h"
+#include "image/color.h"
+#include "math/mat4.h"
+#include "math/vec3.h"
+#include <cstdint>
+
+class BVH;
+class ThreadPool;
+
+enum class RayCastShading {
+    Lit,    // Vertex color under the directional light, with shadows and AO as enabled
+    Unlit   // Interpolated vertex color only: what the rasterizer should produce
+};
+
+struct RayCastSettings {
+    RayCastShading shading = RayCastShading::Lit;
+    vec3 lightDirection = vec3(-0.4f, -1.0f, -0.3f);  // Direction the light travels
+    float ambient = 0.3f;         // Share of the lighting that is ambient (scaled by AO)
+    bool shadows = true;
+    int aoSamples = 4;            // Occlusion rays per pixel, 0 disables AO
+    float aoRadius = 1.5f;        // Occluders farther than this (world units) don't count
+    float rayOffset = 1e-3f;      // Secondary rays start this far off the surface
+    uint32_t seed = 0;            // Change per frame to vary the AO noise
+    color background = color(0.06f, 0.06f, 0.1f, 1.0f);
+    int tileSize = 16;            // Rounded up to a multiple of 8
+};
+
+struct RayCastStats {
+    uint64_t primaryRays = 0;
+    uint64_t shadowRays = 0;
+    uint64_t occlusionRays = 0;
+    uint64_t hits = 0;
+};
+
+// Renders a BVH'd mesh by casting rays, as an alternative to the rasterizer
+// for stills with shadows and ambient occlusion and as a reference image to
+// check rasterized output against.
+//
+// The screen is cut into tiles spread over the ThreadPool. Inside a tile,
+// primary rays go out in 4x2 pixel packets through BVH::intersect8, and the
+// shadow and AO rays of each packet are traced as packets too. Camera rays
+// come from unprojecting each pixel center through the same view and
+// projection matrices the raster path uses, starting at the near plane and
+// ending at the far plane.
+//
+// Only reads the BVH and its mesh, so several casters (or threads) may share them.
+class RayCaster {
+public:
+    explicit RayCaster(const BVH& bvh) : bvh(bvh) {}
+
+    void render(Framebuffer& framebuffer, const mat4& view, const mat4& projection,
+                const RayCastSettings& settings = RayCastSettings(), ThreadPool* pool = nullptr);
+
+    // Counters of the last render()
+    const RayCastStats& getStats() const { return stats; }
+
+private:
+    const BVH& bvh;
+    RayCastStats stats;
+};
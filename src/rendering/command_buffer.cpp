@@ -0,0 +1,347 @@
+#include "command_buffer.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+
+namespace {
+    // Map a float to an unsigned int with the same ordering
+    uint32_t sortableDepth(float depth) {
+        uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+
+    uint64_t makeSortKey(uint8_t layer, bool translucent, CommandType type, float depth) {
+        const uint64_t depthBits = sortableDepth(depth);
+        if (translucent) {
+            // Back-to-front so blending composites correctly
+            return (uint64_t(layer) << 56) | (uint64_t(1) << 55) |
+                   (uint64_t(~depthBits & 0xFFFFFFFFu) << 16) | uint64_t(type);
+        }
+        // Back-to-front too: there is no depth test, so nearer draws must
+        // come last to cover farther ones. Equal depths are grouped by state.
+        // Full-target fills are backgrounds and always go first.
+        if (type == CommandType::Clear || type == CommandType::Gradient) {
+            return (uint64_t(layer) << 56) | (uint64_t(type) << 8);
+        }
+        return (uint64_t(layer) << 56) | (uint64_t(~depthBits & 0xFFFFFFFFu) << 16) | (uint64_t(type) << 8);
+    }
+
+    RasterRect intersect(const RasterRect& a, const RasterRect& b) {
+        return { std::max(a.minX, b.minX), std::max(a.minY, b.minY),
+                 std::min(a.maxX, b.maxX), std::min(a.maxY, b.maxY) };
+    }
+
+    bool isEmpty(const RasterRect& r) {
+        return r.minX >= r.maxX || r.minY >= r.maxY;
+    }
+
+    void writePixel(uint32_t* pixel, uint32_t color, bool translucent) {
+        *pixel = translucent ? blendOver(*pixel, color) : color;
+    }
+
+    // Bresenham, same pixels as DrawLine, restricted to clip.
+    // Instead of stepping from (x0, y0), every row inside clip works out its
+    // run of the line directly, so a band pays only for its own rows. With
+    // h = dx * j - dy * i, DrawLine's stepping visits (x0 + sx * i, y0 + sy * j)
+    // exactly when -dx <= 2h < dx for x-major lines (dx >= dy), and when
+    // -dy < 2h <= dy for y-major ones (a single pixel per row).
+    void lineClipped(int x0, int y0, int x1, int y1, uint32_t color, bool translucent,
+                     Framebuffer& framebuffer, const RasterRect& clip) {
+        uint32_t* pixels = framebuffer.data();
+        const int width = framebuffer.getWidth();
+        const int64_t dx = std::abs(int64_t(x1) - x0);
+        const int64_t dy = std::abs(int64_t(y1) - y0);
+        const int sx = (x0 < x1) ? 1 : -1;
+        const int sy = (y0 < y1) ? 1 : -1;
+
+        const int rowBegin = std::max(std::min(y0, y1), clip.minY);
+        const int rowEnd = std::min(std::max(y0, y1), clip.maxY - 1);
+        for (int y = rowBegin; y <= rowEnd; y++) {
+            const int64_t j = (int64_t(y) - y0) * sy;
+            int64_t first, last;
+            if (dy == 0) {
+                first = 0;
+                last = dx;
+            } else if (dx >= dy) {
+                first = (j == 0) ? 0 : ((2 * j - 1) * dx) / (2 * dy) + 1;
+                last = std::min(dx, ((2 * j + 1) * dx) / (2 * dy));
+            } else {
+                const int64_t n = 2 * dx * j - dy;
+                first = last = (n <= 0) ? 0 : (n + 2 * dy - 1) / (2 * dy);
+            }
+
+            const int64_t xa = x0 + sx * first;
+            const int64_t xb = x0 + sx * last;
+            const int64_t xBegin = std::max<int64_t>(std::min(xa, xb), clip.minX);
+            const int64_t xEnd = std::min<int64_t>(std::max(xa, xb), clip.maxX - 1);
+            uint32_t* row = pixels + size_t(y) * width;
+            for (int64_t x = xBegin; x <= xEnd; x++) {
+                writePixel(&row[x], color, translucent);
+            }
+        }
+    }
+
+    RasterRect lineBounds(int x0, int y0, int x1, int y1) {
+        return { std::min(x0, x1), std::min(y0, y1), std::max(x0, x1) + 1, std::max(y0, y1) + 1 };
+    }
+
+    RasterRect triangleBounds(const float* x, const float* y) {
+        // Conservative: the rasterizer samples pixel centers inside these
+        const float minX = std::min({ x[0], x[1], x[2] });
+        const float minY = std::min({ y[0], y[1], y[2] });
+        const float maxX = std::max({ x[0], x[1], x[2] });
+        const float maxY = std::max({ y[0], y[1], y[2] });
+        auto clampToInt = [](float v) {
+            return static_cast<int>(std::clamp(v, -RASTER_GUARD_BAND, RASTER_GUARD_BAND));
+        };
+        return { clampToInt(std::floor(minX)), clampToInt(std::floor(minY)),
+                 clampToInt(std::floor(maxX)) + 1, clampToInt(std::floor(maxY)) + 1 };
+    }
+
+    constexpr RasterRect EVERYTHING = { INT_MIN, INT_MIN, INT_MAX, INT_MAX };
+}
+
+void CommandBuffer::reset() {
+    commands.clear();
+    sortedOrder.clear();
+    sortedValid = true;
+    currentLayer = 0;
+    currentDepth = 0.0f;
+}
+
+DrawCommand& CommandBuffer::push(CommandType type, uint32_t color, bool translucent) {
+    DrawCommand& command = commands.emplace_back();
+    command.sortKey = makeSortKey(currentLayer, translucent, type, currentDepth);
+    command.type = type;
+    command.layer = currentLayer;
+    command.translucent = translucent ? 1 : 0;
+    command.padding = 0;
+    command.colors[0] = command.colors[1] = command.colors[2] = color;
+    command.bounds = EVERYTHING;
+    sortedValid = false;
+    return command;
+}
+
+void CommandBuffer::clear(uint32_t color) {
+    push(CommandType::Clear, color, false);
+}
+
+void CommandBuffer::fillWithGradient() {
+    push(CommandType::Gradient, 0, false);
+}
+
+void CommandBuffer::drawLine(int x0, int y0, int x1, int y1, color color) {
+    const uint32_t packed = color.toUint32();
+    DrawCommand& command = push(CommandType::Line, packed, getAlpha(packed) != 255);
+    command.x[0] = static_cast<float>(x0);
+    command.y[0] = static_cast<float>(y0);
+    command.x[1] = static_cast<float>(x1);
+    command.y[1] = static_cast<float>(y1);
+    command.bounds = lineBounds(x0, y0, x1, y1);
+}
+
+void CommandBuffer::drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2, color color) {
+    const uint32_t packed = color.toUint32();
+    DrawCommand& command = push(CommandType::TriangleOutline, packed, getAlpha(packed) != 255);
+    command.x[0] = static_cast<float>(x0);
+    command.y[0] = static_cast<float>(y0);
+    command.x[1] = static_cast<float>(x1);
+    command.y[1] = static_cast<float>(y1);
+    command.x[2] = static_cast<float>(x2);
+    command.y[2] = static_cast<float>(y2);
+    command.bounds = triangleBounds(command.x, command.y);
+}
+
+void CommandBuffer::fillTriangle(float x0, float y0, float x1, float y1, float x2, float y2, color color) {
+    const uint32_t packed = color.toUint32();
+    DrawCommand& command = push(CommandType::FillTriangle, packed, getAlpha(packed) != 255);
+    command.x[0] = x0; command.y[0] = y0;
+    command.x[1] = x1; command.y[1] = y1;
+    command.x[2] = x2; command.y[2] = y2;
+    command.bounds = triangleBounds(command.x, command.y);
+}
+
+void CommandBuffer::fillTriangle(float x0, float y0, float x1, float y1, float x2, float y2,
+                                 color c0, color c1, color c2) {
+    const uint32_t p0 = c0.toUint32(), p1 = c1.toUint32(), p2 = c2.toUint32();
+    const bool translucent = (p0 & p1 & p2) >> 24 != 255;
+    DrawCommand& command = push(CommandType::FillTriangleShaded, p0, translucent);
+    command.colors[1] = p1;
+    command.colors[2] = p2;
+    command.x[0] = x0; command.y[0] = y0;
+    command.x[1] = x1; command.y[1] = y1;
+    command.x[2] = x2; command.y[2] = y2;
+    command.bounds = triangleBounds(command.x, command.y);
+}
+
+const std::vector<uint32_t>& CommandBuffer::getSortedOrder() const {
+    if (!sortedValid) {
+        sortedOrder.resize(commands.size());
+        for (uint32_t i = 0; i < sortedOrder.size(); i++) {
+            sortedOrder[i] = i;
+        }
+        // Ties keep recording order
+        std::sort(sortedOrder.begin(), sortedOrder.end(), [this](uint32_t a, uint32_t b) {
+            const uint64_t ka = commands[a].sortKey;
+            const uint64_t kb = commands[b].sortKey;
+            return ka < kb || (ka == kb && a < b);
+        });
+        sortedValid = true;
+    }
+    return sortedOrder;
+}
+
+void CommandBuffer::execute(Framebuffer& framebuffer) const {
+    const RasterRect clip = { 0, 0, framebuffer.getWidth(), framebuffer.getHeight() };
+    for (uint32_t index : getSortedOrder()) {
+        ExecuteCommand(commands[index], framebuffer, clip);
+    }
+}
+
+void RenderQueue::submit(const CommandBuffer& buffer) {
+    buffers.push_back(&buffer);
+}
+
+ArenaSpan<const DrawCommand*> RenderQueue::merge() {
+    mergeMemory.reset();
+
+    size_t total = 0;
+    for (const CommandBuffer* buffer : buffers) {
+        total += buffer->size();
+    }
+    merged = mergeMemory.allocSpan<const DrawCommand*>(total);
+
+    // Every buffer is already sorted; k-way merge them through a min-heap of
+    // buffer heads. Ties go to the buffer submitted first so replay order is
+    // deterministic.
+    struct Cursor {
+        uint64_t key;
+        size_t buffer;
+        size_t position;
+    };
+    auto later = [](const Cursor& a, const Cursor& b) {
+        return std::tie(a.key, a.buffer, a.position) > std::tie(b.key, b.buffer, b.position);
+    };
+    ArenaSpan<Cursor> heads = mergeMemory.allocSpan<Cursor>(buffers.size());
+    size_t headCount = 0;
+    for (size_t b = 0; b < buffers.size(); b++) {
+        const auto& order = buffers[b]->getSortedOrder();
+        if (!order.empty()) {
+            heads[headCount++] = { buffers[b]->getCommands()[order[0]].sortKey, b, 0 };
+            std::push_heap(heads.begin(), heads.begin() + headCount, later);
+        }
+    }
+
+    size_t count = 0;
+    while (headCount > 0) {
+        std::pop_heap(heads.begin(), heads.begin() + headCount, later);
+        Cursor& head = heads[headCount - 1];
+        const auto& order = buffers[head.buffer]->getSortedOrder();
+        const auto& commands = buffers[head.buffer]->getCommands();
+        merged[count++] = &commands[order[head.position]];
+        if (++head.position < order.size()) {
+            head.key = commands[order[head.position]].sortKey;
+            std::push_heap(heads.begin(), heads.begin() + headCount, later);
+        } else {
+            headCount--;
+        }
+    }
+    return merged;
+}
+
+void RenderQueue::execute(Framebuffer& framebuffer, ThreadPool* pool, int bandHeight) {
+    merge();
+
+    const int width = framebuffer.getWidth();
+    const int height = framebuffer.getHeight();
+    bandHeight = std::max(bandHeight, 1);
+    const int bandCount = (height + bandHeight - 1) / bandHeight;
+
+    auto runBand = [&](int band, int) {
+        const RasterRect clip = { 0, band * bandHeight, width, std::min(height, (band + 1) * bandHeight) };
+        for (const DrawCommand* command : merged) {
+            if (!isEmpty(intersect(command->bounds, clip))) {
+                ExecuteCommand(*command, framebuffer, clip);
+            }
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(bandCount, runBand);
+    } else {
+        for (int band = 0; band < bandCount; band++) {
+            runBand(band, 0);
+        }
+    }
+}
+
+void ExecuteCommand(const DrawCommand& command, Framebuffer& framebuffer, const RasterRect& clip) {
+    const RasterRect area = intersect(clip, { 0, 0, framebuffer.getWidth(), framebuffer.getHeight() });
+    if (isEmpty(area)) {
+        return;
+    }
+
+    uint32_t* pixels = framebuffer.data();
+    const int width = framebuffer.getWidth();
+    const bool translucent = command.translucent != 0;
+
+    switch (command.type) {
+    case CommandType::Clear:
+        for (int y = area.minY; y < area.maxY; y++) {
+            std::fill(pixels + y * width + area.minX, pixels + y * width + area.maxX, command.colors[0]);
+        }
+        break;
+
+    case CommandType::Gradient: {
+        // Same formula as FillWithGradient
+        const int height = framebuffer.getHeight();
+        for (int y = area.minY; y < area.maxY; y++) {
+            for (int x = area.minX; x < area.maxX; x++) {
+                uint8_t r = (x * 255) / width;
+                uint8_t g = (y * 255) / height;
+                pixels[y * width + x] = makeColor(r, g, 128);
+            }
+        }
+        break;
+    }
+
+    case CommandType::Line:
+        lineClipped(int(command.x[0]), int(command.y[0]), int(command.x[1]), int(command.y[1]),
+                    command.colors[0], translucent, framebuffer, area);
+        break;
+
+    case CommandType::TriangleOutline:
+        for (int i = 0; i < 3; i++) {
+            const int j = (i + 1) % 3;
+            lineClipped(int(command.x[i]), int(command.y[i]), int(command.x[j]), int(command.y[j]),
+                        command.colors[0], translucent, framebuffer, area);
+        }
+        break;
+
+    case CommandType::FillTriangle: {
+        const uint32_t packed = command.colors[0];
+        RasterizeTriangle(command.x[0], command.y[0], command.x[1], command.y[1],
+                          command.x[2], command.y[2], area,
+                          [&](int x, int y, float, float, float) {
+            writePixel(&pixels[y * width + x], packed, translucent);
+        });
+        break;
+    }
+
+    case CommandType::FillTriangleShaded: {
+        const color c0 = color::fromUint32(command.colors[0]);
+        const color c1 = color::fromUint32(command.colors[1]);
+        const color c2 = color::fromUint32(command.colors[2]);
+        RasterizeTriangle(command.x[0], command.y[0], command.x[1], command.y[1],
+                          command.x[2], command.y[2], area,
+                          [&](int x, int y, float l0, float l1, float l2) {
+            writePixel(&pixels[y * width + x], (c0 * l0 + c1 * l1 + c2 * l2).toUint32(), translucent);
+        });
+        break;
+    }
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "core/frame_arena.h"
+#include "core/framebuffer.h"
+#include "image/color.h"
+#include "rendering/rasterizer.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+enum class CommandType : uint8_t {
+    Clear,
+    Gradient,
+    Line,
+    TriangleOutline,
+    FillTriangle,
+    FillTriangleShaded,
+};
+
+// One recorded draw call. Fixed size (one cache line) so buffers are flat
+// arrays that can be recorded, sorted and replayed without chasing pointers.
+struct DrawCommand {
+    uint64_t sortKey;
+    CommandType type;
+    uint8_t layer;
+    uint8_t translucent;
+    uint8_t padding;
+    uint32_t colors[3];     // ARGB8888, one per vertex (only [0] for flat draws)
+    float x[3];
+    float y[3];
+    RasterRect bounds;      // Pixels the command may touch (max exclusive)
+};
+
+// Records draw calls instead of executing them.
+//
+// Each recording thread owns its own CommandBuffer, so recording never locks.
+// Buffers are replayed through a RenderQueue. A buffer that is not reset keeps
+// its commands (and its sorted order), so frame-static layers such as UI or
+// background can be recorded once and resubmitted every frame for free.
+//
+// Sort order, from the most significant key down:
+//   1. layer, so layers keep painter's order
+//   2. opaque before translucent
+//   3. depth, back-to-front (larger depth first)
+//   4. command type (the pipeline state), then recording order
+// Clears and gradients ignore depth and run first in their layer.
+//
+// Depth ranks above state for opaque draws too: there is no depth buffer, so
+// overlapping draws are only resolved correctly by painting the nearest last.
+// State grouping is therefore limited to commands that share a depth; give
+// draws that may be batched (UI, a flat background layer) the same depth to
+// keep them together. Draws inside one layer that rely on submission order
+// for overlap must use distinct layers or depths.
+class CommandBuffer {
+public:
+    // Drop all commands, keep the allocated memory
+    void reset();
+
+    // State applied to subsequently recorded commands
+    void setLayer(uint8_t layer) { currentLayer = layer; }
+    void setDepth(float depth) { currentDepth = depth; }
+
+    // Recording - mirrors the immediate-mode functions in image/primitives.h
+    void clear(uint32_t color = 0xFF000000);
+    void fillWithGradient();
+    void drawLine(int x0, int y0, int x1, int y1, color color);
+    void drawTriangle(int x0, int y0, int x1, int y1, int x2, int y2, color color);
+    void fillTriangle(float x0, float y0, float x1, float y1, float x2, float y2, color color);
+    void fillTriangle(float x0, float y0, float x1, float y1, float x2, float y2,
+                      color c0, color c1, color c2);
+
+    size_t size() const { return commands.size(); }
+    bool empty() const { return commands.empty(); }
+    const std::vector<DrawCommand>& getCommands() const { return commands; }
+
+    // Command indices in execution order (sorted lazily, cached until the
+    // next recording call)
+    const std::vector<uint32_t>& getSortedOrder() const;
+
+    // Replay on the calling thread
+    void execute(Framebuffer& framebuffer) const;
+
+private:
+    DrawCommand& push(CommandType type, uint32_t color, bool translucent);
+
+    std::vector<DrawCommand> commands;
+    mutable std::vector<uint32_t> sortedOrder;
+    mutable bool sortedValid = true;
+
+    uint8_t currentLayer = 0;
+    float currentDepth = 0.0f;
+};
+
+// Collects the buffers submitted for a frame and replays them together.
+// Replay splits the framebuffer into row bands and runs the bands on a
+// ThreadPool: every band walks the merged command list clipped to itself, so
+// each pixel is written by exactly one thread, in sorted order.
+//
+// The merged list lives in the queue's own arena, which is recycled by the
+// next merge(): once it has grown to the largest frame, merging allocates
+// nothing.
+class RenderQueue {
+public:
+    // Buffers must stay alive (and unmodified) until execute() returns
+    void submit(const CommandBuffer& buffer);
+    void reset() { buffers.clear(); }
+
+    // Merge, then replay. pool may be null for single-threaded replay.
+    void execute(Framebuffer& framebuffer, ThreadPool* pool = nullptr, int bandHeight = 32);
+
+    // Merge the submitted buffers into one list in execution order.
+    // The list is valid until the next merge() or execute().
+    ArenaSpan<const DrawCommand*> merge();
+
+    size_t getCommandCount() const { return merged.size(); }
+    ArenaStats getMergeStats() const { return mergeMemory.stats(); }
+
+private:
+    std::vector<const CommandBuffer*> buffers;
+    LinearArena mergeMemory;
+    ArenaSpan<const DrawCommand*> merged;
+};
+
+// Run one command, touching only pixels inside clip
+void ExecuteCommand(const DrawCommand& command, Framebuffer& framebuffer, const RasterRect& clip);
@@ -0,0 +1,200 @@
+#include "oit_buffer.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+
+namespace {
+    constexpr uint64_t EMPTY_HEAD = 0xFFFFFFFFull;  // Length 0, no first fragment
+
+    void atomicMax(std::atomic<int>& target, int value) {
+        int current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+OITBuffer::OITBuffer(int width, int height, const OITConfig& config) : config(config) {
+    this->config.maxFragmentsPerPixel = std::clamp(config.maxFragmentsPerPixel, 1, MAX_PER_PIXEL);
+    this->config.tileSize = std::max(config.tileSize, 8);
+    this->config.initialFragments = std::min(config.initialFragments, config.maxFragments);
+    capacity = this->config.initialFragments;
+    fragments = std::make_unique<Fragment[]>(capacity);
+    resize(width, height);
+}
+
+void OITBuffer::resize(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+    heads = std::make_unique<std::atomic<uint64_t>[]>(size_t(width) * height);
+    for (size_t i = 0; i < size_t(width) * height; i++) {
+        heads[i].store(EMPTY_HEAD, std::memory_order_relaxed);
+    }
+    cursor = 0;
+    resolved = true;
+}
+
+void OITBuffer::reset() {
+    // Lists left over from a frame that was never resolved
+    if (!resolved && cursor.load() > 0) {
+        for (size_t i = 0; i < size_t(width) * height; i++) {
+            heads[i].store(EMPTY_HEAD, std::memory_order_relaxed);
+        }
+    }
+
+    // Grow to last frame's demand (plus some headroom), never past the cap
+    const uint32_t demand = cursor.load();
+    if (demand > capacity && capacity < config.maxFragments) {
+        capacity = static_cast<uint32_t>(std::min<uint64_t>(config.maxFragments, uint64_t(demand) + demand / 8));
+        fragments = std::make_unique<Fragment[]>(capacity);
+    }
+
+    cursor = 0;
+    dropped = 0;
+    discarded = 0;
+    maxComplexity = 0;
+    resolved = false;
+}
+
+bool OITBuffer::insert(int x, int y, float depth, uint32_t color) {
+    if (x < 0 || y < 0 || x >= width || y >= height) {
+        return false;
+    }
+    std::atomic<uint64_t>& head = heads[size_t(y) * width + x];
+    const uint32_t cap = static_cast<uint32_t>(config.maxFragmentsPerPixel);
+
+    uint64_t current = head.load(std::memory_order_relaxed);
+    if (config.overflow == OITOverflow::DropNewest && (current >> 32) >= cap) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const uint32_t index = cursor.fetch_add(1, std::memory_order_relaxed);
+    if (index >= capacity) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    Fragment& fragment = fragments[index];
+    fragment.depth = depth;
+    fragment.color = color;
+
+    // Once allocated the fragment is always linked, even if a racing insert
+    // pushed the list past the cap in the meantime
+    uint64_t next;
+    do {
+        fragment.next = static_cast<uint32_t>(current);
+        next = (((current >> 32) + 1) << 32) | index;
+    } while (!head.compare_exchange_weak(current, next, std::memory_order_release, std::memory_order_relaxed));
+    return true;
+}
+
+void OITBuffer::insertTriangle(const float x[3], const float y[3], const float depth[3], const color colors[3]) {
+    insertTriangle(x, y, depth, colors, RasterRect{0, 0, width, height});
+}
+
+void OITBuffer::insertTriangle(const float x[3], const float y[3], const float depth[3],
+                               const color colors[3], const RasterRect& clip) {
+    RasterRect area = clip;
+    area.minX = std::max(area.minX, 0);
+    area.minY = std::max(area.minY, 0);
+    area.maxX = std::min(area.maxX, width);
+    area.maxY = std::min(area.maxY, height);
+    RasterizeTriangle(x[0], y[0], x[1], y[1], x[2], y[2], area,
+                      [&](int px, int py, float l0, float l1, float l2) {
+        insert(px, py, depth[0] * l0 + depth[1] * l1 + depth[2] * l2,
+               (colors[0] * l0 + colors[1] * l1 + colors[2] * l2).toUint32());
+    });
+}
+
+void OITBuffer::resolveTile(int tileX, int tileY, Framebuffer& framebuffer) {
+    const int x0 = tileX * config.tileSize;
+    const int y0 = tileY * config.tileSize;
+    const int x1 = std::min(x0 + config.tileSize, std::min(width, framebuffer.getWidth()));
+    const int y1 = std::min(y0 + config.tileSize, std::min(height, framebuffer.getHeight()));
+    const int cap = config.maxFragmentsPerPixel;
+
+    Fragment nearest[MAX_PER_PIXEL];
+    uint32_t tileDiscarded = 0;
+    int tileComplexity = 0;
+
+    for (int y = y0; y < y1; y++) {
+        uint32_t* row = framebuffer.data() + size_t(y) * framebuffer.getWidth();
+        for (int x = x0; x < x1; x++) {
+            std::atomic<uint64_t>& head = heads[size_t(y) * width + x];
+            const uint64_t list = head.load(std::memory_order_acquire);
+            if (static_cast<uint32_t>(list) == END) {
+                continue;
+            }
+            head.store(EMPTY_HEAD, std::memory_order_relaxed);
+
+            // Keep the `cap` nearest fragments, sorted near to far. Ties are
+            // broken by color so the result never depends on insertion order.
+            int count = 0;
+            int total = 0;
+            for (uint32_t index = static_cast<uint32_t>(list); index != END; index = fragments[index].next) {
+                const Fragment& f = fragments[index];
+                total++;
+                auto nearer = [&](const Fragment& a, const Fragment& b) {
+                    return a.depth < b.depth || (a.depth == b.depth && a.color < b.color);
+                };
+                if (count == cap && !nearer(f, nearest[cap - 1])) {
+                    continue;
+                }
+                int i = (count == cap) ? cap - 1 : count++;
+                while (i > 0 && nearer(f, nearest[i - 1])) {
+                    nearest[i] = nearest[i - 1];
+                    i--;
+                }
+                nearest[i] = f;
+            }
+            tileDiscarded += total - count;
+            tileComplexity = std::max(tileComplexity, total);
+
+            // Back to front over the opaque result
+            uint32_t pixel = row[x];
+            for (int i = count - 1; i >= 0; i--) {
+                pixel = blendOver(pixel, nearest[i].color);
+            }
+            row[x] = pixel;
+        }
+    }
+
+    if (tileDiscarded) {
+        discarded.fetch_add(tileDiscarded, std::memory_order_relaxed);
+    }
+    atomicMax(maxComplexity, tileComplexity);
+}
+
+void OITBuffer::resolve(Framebuffer& framebuffer, ThreadPool* pool) {
+    const int tilesX = (width + config.tileSize - 1) / config.tileSize;
+    const int tilesY = (height + config.tileSize - 1) / config.tileSize;
+
+    auto resolveJob = [&](int tile, int) {
+        resolveTile(tile % tilesX, tile / tilesX, framebuffer);
+    };
+    if (pool) {
+        pool->parallelFor(tilesX * tilesY, resolveJob);
+    } else {
+        for (int tile = 0; tile < tilesX * tilesY; tile++) {
+            resolveJob(tile, 0);
+        }
+    }
+
+    // Lists outside the framebuffer (if it is smaller) were not consumed
+    if (framebuffer.getWidth() < width || framebuffer.getHeight() < height) {
+        for (size_t i = 0; i < size_t(width) * height; i++) {
+            heads[i].store(EMPTY_HEAD, std::memory_order_relaxed);
+        }
+    }
+    resolved = true;
+}
+
+OITStats OITBuffer::getStats() const {
+    OITStats stats;
+    const uint32_t allocated = cursor.load();
+    stats.fragmentsStored = std::min(allocated, capacity);
+    stats.fragmentsDropped = dropped.load();
+    stats.fragmentsDiscarded = discarded.load();
+    stats.fragmentsRequested = stats.fragmentsStored + stats.fragmentsDropped;
+    stats.poolCapacity = capacity;
+    stats.maxDepthComplexity = maxComplexity.load();
+    return stats;
+}
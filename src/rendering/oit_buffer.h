@@ -0,0 +1,109 @@
+#pragma once
+
+#include "core/framebuffer.h"
+#include "image/color.h"
+#include "rendering/rasterizer.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+class ThreadPool;
+
+// What to do with a fragment that lands on a pixel already holding
+// maxFragmentsPerPixel fragments
+enum class OITOverflow {
+    DropNewest,   // Discard it. Cheapest; which fragments survive depends on thread timing.
+    KeepNearest   // Store it anyway (pool permitting); resolve composites only the nearest ones. Deterministic.
+};
+
+struct OITConfig {
+    uint32_t initialFragments = 1u << 20;   // Pool size to start with
+    uint32_t maxFragments = 1u << 24;       // Hard cap on the pool (12 bytes each)
+    int maxFragmentsPerPixel = 16;          // Fragments composited per pixel, at most 64
+    OITOverflow overflow = OITOverflow::KeepNearest;
+    int tileSize = 32;                      // Resolve work unit
+};
+
+struct OITStats {
+    uint32_t fragmentsStored = 0;
+    uint32_t fragmentsDropped = 0;   // Pool full, or per-pixel cap with DropNewest
+    uint32_t fragmentsDiscarded = 0; // Stored but beyond the per-pixel cap at resolve (KeepNearest)
+    uint32_t fragmentsRequested = 0; // Demand this frame, including dropped ones
+    uint32_t poolCapacity = 0;
+    int maxDepthComplexity = 0;      // Longest per-pixel list seen by resolve
+};
+
+// Order-independent transparency with per-pixel fragment lists.
+//
+// Translucent geometry is not blended when drawn. Each covered pixel instead
+// gets a (depth, color) fragment pushed onto its own linked list. Fragments
+// come from one pool shared by all threads: allocation is a single atomic
+// add, and list insertion is a compare-and-swap on the pixel's head (which
+// also carries the list length). Drawing therefore needs neither sorting nor
+// locks, and intersecting translucent triangles come out right.
+//
+// resolve() then walks the screen tile by tile on the ThreadPool, sorts each
+// pixel's fragments back to front and blends them over the framebuffer
+// (which should hold the opaque pass). There is no depth buffer: translucent
+// fragments are not occluded by opaque geometry.
+//
+// The pool never reallocates during a frame. When a frame asks for more than
+// it holds, the extra fragments are dropped and the next reset() grows the
+// pool to the demand seen, up to maxFragments.
+//
+// Frame: reset(); insert*() from any threads; resolve().
+class OITBuffer {
+public:
+    OITBuffer(int width, int height, const OITConfig& config = OITConfig());
+
+    // Start a new frame. Also applies pool growth and, if the previous frame
+    // was never resolved, clears its lists. Not thread-safe.
+    void reset();
+
+    // Change the screen size (drops the current frame's fragments)
+    void resize(int newWidth, int newHeight);
+
+    // Thread-safe. Smaller depth = nearer. Returns false if the fragment was dropped.
+    bool insert(int x, int y, float depth, uint32_t color);
+
+    // Thread-safe. Rasterizes a triangle into fragments with interpolated
+    // depth and color (ARGB8888, straight alpha).
+    void insertTriangle(const float x[3], const float y[3], const float depth[3],
+                        const color colors[3], const RasterRect& clip);
+    void insertTriangle(const float x[3], const float y[3], const float depth[3], const color colors[3]);
+
+    // Sort and composite every pixel's fragments over framebuffer, leaving
+    // the lists empty. Tiles are spread over pool (may be null).
+    void resolve(Framebuffer& framebuffer, ThreadPool* pool = nullptr);
+
+    OITStats getStats() const;
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    static constexpr uint32_t END = 0xFFFFFFFFu;
+    static constexpr int MAX_PER_PIXEL = 64;
+
+    struct Fragment {
+        float depth;
+        uint32_t color;
+        uint32_t next;
+    };
+
+    void resolveTile(int tileX, int tileY, Framebuffer& framebuffer);
+
+    int width = 0;
+    int height = 0;
+    OITConfig config;
+
+    // Per pixel: list length << 32 | index of the first fragment
+    std::unique_ptr<std::atomic<uint64_t>[]> heads;
+    std::unique_ptr<Fragment[]> fragments;
+    uint32_t capacity = 0;
+    std::atomic<uint32_t> cursor{0};
+
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<uint32_t> discarded{0};
+    std::atomic<int> maxComplexity{0};
+    bool resolved = true;  // Lists are known to be empty
+};
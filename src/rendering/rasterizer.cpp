@@ -0,0 +1,95 @@
+#include "rasterizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Round to the nearest 1/16 pixel
+    int32_t toFixed(float v) {
+        return static_cast<int32_t>(std::lround(v * SUBPIXEL_ONE));
+    }
+
+    bool inGuardBand(float v) {
+        // Written so NaN fails the test
+        return v > -RASTER_GUARD_BAND && v < RASTER_GUARD_BAND;
+    }
+
+    // Top-left rule for a y-down screen with positive (clockwise on screen)
+    // winding: a top edge is horizontal with the interior below it, a left
+    // edge goes up the screen.
+    bool isTopLeft(int32_t ax, int32_t ay, int32_t bx, int32_t by) {
+        const int32_t dy = ay - by;
+        const int32_t dx = bx - ax;
+        return dy > 0 || (dy == 0 && dx > 0);
+    }
+}
+
+bool SetupTriangle(float x0, float y0, float x1, float y1, float x2, float y2,
+                   const RasterRect& clip, TriangleSetup& setup) {
+    if (!inGuardBand(x0) || !inGuardBand(y0) || !inGuardBand(x1) ||
+        !inGuardBand(y1) || !inGuardBand(x2) || !inGuardBand(y2)) {
+        return false;
+    }
+
+    int32_t fx[3] = { toFixed(x0), toFixed(x1), toFixed(x2) };
+    int32_t fy[3] = { toFixed(y0), toFixed(y1), toFixed(y2) };
+
+    // Twice the signed area, in fixed units squared
+    int64_t area = int64_t(fx[1] - fx[0]) * (fy[2] - fy[0]) -
+                   int64_t(fy[1] - fy[0]) * (fx[2] - fx[0]);
+    if (area == 0) {
+        return false;
+    }
+
+    // Normalize winding so the interior is where all edge functions are positive
+    setup.swapped = area < 0;
+    if (setup.swapped) {
+        std::swap(fx[1], fx[2]);
+        std::swap(fy[1], fy[2]);
+        area = -area;
+    }
+
+    // Pixel bounding box, clipped. Pixel X is sampled at X + 0.5.
+    const int32_t minFx = std::min({ fx[0], fx[1], fx[2] });
+    const int32_t maxFx = std::max({ fx[0], fx[1], fx[2] });
+    const int32_t minFy = std::min({ fy[0], fy[1], fy[2] });
+    const int32_t maxFy = std::max({ fy[0], fy[1], fy[2] });
+
+    setup.minX = std::max(clip.minX, minFx >> SUBPIXEL_BITS);
+    setup.minY = std::max(clip.minY, minFy >> SUBPIXEL_BITS);
+    setup.maxX = std::min(clip.maxX, (maxFx >> SUBPIXEL_BITS) + 1);
+    setup.maxY = std::min(clip.maxY, (maxFy >> SUBPIXEL_BITS) + 1);
+    if (setup.minX >= setup.maxX || setup.minY >= setup.maxY) {
+        return false;
+    }
+
+    // First sample position in fixed point
+    const int64_t px = int64_t(setup.minX) * SUBPIXEL_ONE + SUBPIXEL_ONE / 2;
+    const int64_t py = int64_t(setup.minY) * SUBPIXEL_ONE + SUBPIXEL_ONE / 2;
+
+    // Edge i runs from vertex j to vertex k (opposite vertex i)
+    static constexpr int edgeFrom[3] = { 1, 2, 0 };
+    static constexpr int edgeTo[3]   = { 2, 0, 1 };
+
+    for (int i = 0; i < 3; i++) {
+        const int32_t ax = fx[edgeFrom[i]], ay = fy[edgeFrom[i]];
+        const int32_t bx = fx[edgeTo[i]],   by = fy[edgeTo[i]];
+
+        // E(p) = (bx - ax) * (py - ay) - (by - ay) * (px - ax)
+        const int64_t a = int64_t(ay) - by;
+        const int64_t b = int64_t(bx) - ax;
+        int64_t e = a * (px - ax) + b * (py - ay);
+
+        // Pixels exactly on an edge belong to the triangle only for top/left
+        // edges; elsewhere E must be strictly positive, i.e. E - 1 >= 0.
+        if (!isTopLeft(ax, ay, bx, by)) {
+            e -= 1;
+        }
+
+        setup.stepX[i] = a * SUBPIXEL_ONE;
+        setup.stepY[i] = b * SUBPIXEL_ONE;
+        setup.rowStart[i] = e;
+    }
+
+    setup.invArea = 1.0f / static_cast<float>(area);
+    return true;
+}
@@ -0,0 +1,70 @@
+#include "resolution_scaler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Frames to wait after a change before reacting again, so the average
+    // reflects the new resolution
+    constexpr int SETTLE_FRAMES = 8;
+
+    // Largest single step up (per axis)
+    constexpr float MAX_GROW_STEP = 1.05f;
+
+    int alignedSize(int size, float scale, int alignment) {
+        const int scaled = static_cast<int>(std::lround(size * scale));
+        const int aligned = (scaled + alignment / 2) / alignment * alignment;
+        return std::clamp(aligned, std::min(alignment, size), size);
+    }
+}
+
+ResolutionScaler::ResolutionScaler(const ResolutionScalerConfig& config)
+    : config(config), scale(config.maxScale) {
+    this->config.alignment = std::max(config.alignment, 1);
+}
+
+void ResolutionScaler::reset() {
+    scale = config.maxScale;
+    averageMs = 0.0;
+    framesUnderBudget = 0;
+    cooldown = 0;
+}
+
+bool ResolutionScaler::update(double frameMs) {
+    averageMs = averageMs > 0.0
+        ? averageMs + config.smoothing * (frameMs - averageMs)
+        : frameMs;
+
+    if (cooldown > 0) {
+        cooldown--;
+        return false;
+    }
+
+    const float previous = scale;
+    if (averageMs > config.targetFrameMs) {
+        // Over budget: shrink straight to the size that should fit
+        scale *= static_cast<float>(std::sqrt(config.targetFrameMs / averageMs));
+        framesUnderBudget = 0;
+    } else if (averageMs < config.targetFrameMs * config.upscaleHeadroom) {
+        if (++framesUnderBudget >= config.upscaleDelay) {
+            const float fit = static_cast<float>(std::sqrt(config.targetFrameMs * config.upscaleHeadroom / averageMs));
+            scale *= std::min(fit, MAX_GROW_STEP);
+            framesUnderBudget = 0;
+        }
+    } else {
+        framesUnderBudget = 0;
+    }
+    scale = std::clamp(scale, config.minScale, config.maxScale);
+
+    if (scale == previous) {
+        return false;
+    }
+    // Restart the average from the current estimate at the new size
+    averageMs *= (scale * scale) / (previous * previous);
+    cooldown = SETTLE_FRAMES;
+    return true;
+}
+
+void ResolutionScaler::getRenderSize(int outputWidth, int outputHeight, int& renderWidth, int& renderHeight) const {
+    renderWidth = alignedSize(outputWidth, scale, config.alignment);
+    renderHeight = alignedSize(outputHeight, scale, config.alignment);
+}
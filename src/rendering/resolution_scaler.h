@@ -0,0 +1,46 @@
+#pragma once
+
+struct ResolutionScalerConfig {
+    double targetFrameMs = 16.0;   // Budget for the measured part of the frame
+    float minScale = 0.5f;         // Per-axis scale limits
+    float maxScale = 1.0f;
+    float smoothing = 0.2f;        // Weight of the newest sample in the moving average
+    float upscaleHeadroom = 0.8f;  // Only grow while under this fraction of the budget
+    int upscaleDelay = 30;         // Frames under the headroom before growing
+    int alignment = 8;             // Render sizes are rounded to multiples of this
+};
+
+// Picks the internal render resolution from measured frame times.
+//
+// Cost is roughly proportional to pixel count, so when the smoothed frame
+// time goes over budget the per-axis scale drops by sqrt(budget / time) in
+// one step. Growing back is deliberately slow (small steps, only after a run
+// of frames with headroom) so the resolution does not oscillate around the
+// budget. Render sizes are aligned so small scale changes don't resize the
+// framebuffer (and throw away cached tiles) every frame.
+//
+// The render target must be an owned Framebuffer: external (shared memory)
+// framebuffers can't change size, and their resize() returns false.
+class ResolutionScaler {
+public:
+    explicit ResolutionScaler(const ResolutionScalerConfig& config = ResolutionScalerConfig());
+
+    // Feed the time the last frame took; returns true if the scale changed
+    bool update(double frameMs);
+
+    // Internal resolution for the given output size
+    void getRenderSize(int outputWidth, int outputHeight, int& renderWidth, int& renderHeight) const;
+
+    float getScale() const { return scale; }
+    double getAverageFrameMs() const { return averageMs; }
+
+    // Jump back to full resolution and forget the frame-time history
+    void reset();
+
+private:
+    ResolutionScalerConfig config;
+    float scale;
+    double averageMs = 0.0;
+    int framesUnderBudget = 0;
+    int cooldown = 0;
+};
@@ -0,0 +1,149 @@
+#include "tile_cache.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr uint64_t EMPTY_TILE_HASH = 0x9E3779B97F4A7C15ull;
+
+    // 64-bit finalizer (splitmix64): cheap and well mixed
+    uint64_t mix64(uint64_t h) {
+        h ^= h >> 30;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 27;
+        h *= 0x94D049BB133111EBull;
+        h ^= h >> 31;
+        return h;
+    }
+
+    uint64_t hashCommand(const DrawCommand& command) {
+        static_assert(sizeof(DrawCommand) % sizeof(uint64_t) == 0, "DrawCommand must hash as whole words");
+        uint64_t words[sizeof(DrawCommand) / sizeof(uint64_t)];
+        std::memcpy(words, &command, sizeof(words));
+        uint64_t h = 0;
+        for (uint64_t word : words) {
+            h = mix64(h ^ word);
+        }
+        return h;
+    }
+
+    struct TileRange {
+        int minX, minY, maxX, maxY;   // Inclusive
+    };
+}
+
+TileCache::TileCache(int tileSize) : tileSize(std::max(tileSize, 8)) {
+}
+
+void TileCache::invalidate() {
+    target = nullptr;
+}
+
+void TileCache::resize(const Framebuffer& framebuffer) {
+    width = framebuffer.getWidth();
+    height = framebuffer.getHeight();
+    tilesX = (width + tileSize - 1) / tileSize;
+    tilesY = (height + tileSize - 1) / tileSize;
+    const size_t tileCount = size_t(tilesX) * tilesY;
+    binStart.resize(tileCount);
+    binEnd.resize(tileCount);
+    frameHashes.resize(tileCount);
+    // Can't match any real hash: everything redraws once
+    tileHashes.assign(tileCount, ~EMPTY_TILE_HASH);
+    target = framebuffer.data();
+}
+
+void TileCache::execute(RenderQueue& queue, Framebuffer& framebuffer, ThreadPool* pool) {
+    if (target != framebuffer.data() || width != framebuffer.getWidth() || height != framebuffer.getHeight()) {
+        resize(framebuffer);
+    }
+
+    const ArenaSpan<const DrawCommand*> commands = queue.merge();
+    const size_t tileCount = frameHashes.size();
+
+    auto tilesCovered = [&](const DrawCommand& command, TileRange& range) {
+        range.minX = std::max(command.bounds.minX, 0) / tileSize;
+        range.minY = std::max(command.bounds.minY, 0) / tileSize;
+        const int maxX = std::min(command.bounds.maxX, width) - 1;
+        const int maxY = std::min(command.bounds.maxY, height) - 1;
+        if (maxX < 0 || maxY < 0 || range.minX >= tilesX || range.minY >= tilesY) {
+            return false;
+        }
+        range.maxX = maxX / tileSize;
+        range.maxY = maxY / tileSize;
+        return true;
+    };
+
+    // Count the commands overlapping each tile and fold them into the tile hashes
+    std::fill(binEnd.begin(), binEnd.end(), 0u);
+    std::fill(frameHashes.begin(), frameHashes.end(), EMPTY_TILE_HASH);
+    for (const DrawCommand* command : commands) {
+        TileRange range;
+        if (!tilesCovered(*command, range)) {
+            continue;
+        }
+        const uint64_t commandHash = hashCommand(*command);
+        for (int ty = range.minY; ty <= range.maxY; ty++) {
+            for (int tx = range.minX; tx <= range.maxX; tx++) {
+                const size_t tile = size_t(ty) * tilesX + tx;
+                binEnd[tile]++;
+                frameHashes[tile] = mix64(frameHashes[tile] + commandHash);
+            }
+        }
+    }
+
+    // Then bin the command indices, still in execution order, into one array
+    uint32_t total = 0;
+    for (size_t tile = 0; tile < tileCount; tile++) {
+        binStart[tile] = total;
+        total += binEnd[tile];
+        binEnd[tile] = binStart[tile];
+    }
+    binMemory.reset();
+    binIndices = binMemory.allocSpan<uint32_t>(total);
+    for (uint32_t index = 0; index < commands.size(); index++) {
+        TileRange range;
+        if (!tilesCovered(*commands[index], range)) {
+            continue;
+        }
+        for (int ty = range.minY; ty <= range.maxY; ty++) {
+            for (int tx = range.minX; tx <= range.maxX; tx++) {
+                binIndices[binEnd[size_t(ty) * tilesX + tx]++] = index;
+            }
+        }
+    }
+
+    // Compare with last frame
+    dirtyTiles.clear();
+    stats = {};
+    stats.tiles = static_cast<int>(tileCount);
+    for (size_t tile = 0; tile < tileCount; tile++) {
+        if (frameHashes[tile] == tileHashes[tile]) {
+            stats.hits++;
+        } else {
+            dirtyTiles.push_back(static_cast<int>(tile));
+            stats.commandsExecuted += static_cast<int>(binEnd[tile] - binStart[tile]);
+            tileHashes[tile] = frameHashes[tile];
+        }
+    }
+    stats.misses = static_cast<int>(dirtyTiles.size());
+
+    auto renderTile = [&](int job, int) {
+        const int tile = dirtyTiles[job];
+        const int tx = tile % tilesX;
+        const int ty = tile / tilesX;
+        const RasterRect clip = { tx * tileSize, ty * tileSize,
+                                  std::min(width, (tx + 1) * tileSize), std::min(height, (ty + 1) * tileSize) };
+        for (uint32_t entry = binStart[tile]; entry < binEnd[tile]; entry++) {
+            ExecuteCommand(*commands[binIndices[entry]], framebuffer, clip);
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(static_cast<int>(dirtyTiles.size()), renderTile);
+    } else {
+        for (int job = 0; job < static_cast<int>(dirtyTiles.size()); job++) {
+            renderTile(job, 0);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "rendering/command_buffer.h"
+#include <cstdint>
+#include <vector>
+
+struct TileCacheStats {
+    int tiles = 0;              // Tiles on screen
+    int hits = 0;               // Tiles whose pixels were kept from last frame
+    int misses = 0;             // Tiles re-rasterized this frame
+    int commandsExecuted = 0;   // Command executions summed over missed tiles
+};
+
+// Incremental rendering across frames.
+//
+// The screen is split into tiles. Every frame each tile gets a hash of the
+// commands (type, state, geometry, colors) that overlap it, in execution
+// order. Tiles whose hash matches the previous frame keep their pixels and
+// are not rasterized at all; only the others are replayed, clipped to the
+// tile. Static CAD/dashboard views then cost roughly in proportion to what
+// changed on screen.
+//
+// The target framebuffer must be owned by the cache between frames: don't
+// clear or draw into it outside execute(), or call invalidate() if you do.
+// Record a clear or full-screen background so every tile has an owner -
+// a tile that nothing draws into keeps whatever it showed before.
+//
+// The per-tile command lists are rebuilt every frame in the cache's own
+// arena, so steady-state frames bin without touching the heap.
+class TileCache {
+public:
+    explicit TileCache(int tileSize = 32);
+
+    // Replay the queue's commands into framebuffer, skipping unchanged tiles.
+    // Missed tiles are distributed over pool (may be null).
+    void execute(RenderQueue& queue, Framebuffer& framebuffer, ThreadPool* pool = nullptr);
+
+    // Force every tile to be redrawn on the next execute()
+    void invalidate();
+
+    const TileCacheStats& getStats() const { return stats; }
+    int getTileSize() const { return tileSize; }
+
+private:
+    void resize(const Framebuffer& framebuffer);
+
+    int tileSize;
+    int tilesX = 0;
+    int tilesY = 0;
+    int width = 0;
+    int height = 0;
+    const uint32_t* target = nullptr;   // Framebuffer the hashes describe
+
+    std::vector<uint64_t> tileHashes;   // Previous frame's hash per tile
+    std::vector<uint64_t> frameHashes;  // This frame's hash per tile
+    std::vector<uint32_t> binStart;     // Tile's first entry in binIndices
+    std::vector<uint32_t> binEnd;       // One past its last entry
+    std::vector<int> dirtyTiles;
+
+    LinearArena binMemory;              // Recycled every frame
+    ArenaSpan<uint32_t> binIndices;     // Merged command indices, grouped by tile
+
+    TileCacheStats stats;
+};
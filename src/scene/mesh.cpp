@@ -0,0 +1,45 @@
+#include "mesh.h"
+
+void Mesh::clear() {
+    positions.clear();
+    colors.clear();
+    indices.clear();
+}
+
+uint32_t Mesh::addVertex(const vec3& position, const color& c) {
+    positions.push_back(position);
+    colors.push_back(c);
+    return static_cast<uint32_t>(positions.size() - 1);
+}
+
+void Mesh::addTriangle(uint32_t a, uint32_t b, uint32_t c) {
+    indices.push_back(a);
+    indices.push_back(b);
+    indices.push_back(c);
+}
+
+void Mesh::appendBox(const mat4& transform, const color& c) {
+    // Faces as corner indices (bit 0 = +x, bit 1 = +y, bit 2 = +z),
+    // counter-clockwise seen from outside
+    static const int faces[6][4] = {
+        {0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}
+    };
+    for (const auto& face : faces) {
+        uint32_t corners[4];
+        for (int i = 0; i < 4; i++) {
+            const int k = face[i];
+            corners[i] = addVertex(transform * vec3(k & 1 ? 1.0f : -1.0f, k & 2 ? 1.0f : -1.0f, k & 4 ? 1.0f : -1.0f), c);
+        }
+        addTriangle(corners[0], corners[1], corners[2]);
+        addTriangle(corners[0], corners[2], corners[3]);
+    }
+}
+
+void Mesh::appendQuad(const mat4& transform, const color& c) {
+    const uint32_t a = addVertex(transform * vec3(-1.0f, 0.0f, -1.0f), c);
+    const uint32_t b = addVertex(transform * vec3(-1.0f, 0.0f, 1.0f), c);
+    const uint32_t d = addVertex(transform * vec3(1.0f, 0.0f, 1.0f), c);
+    const uint32_t e = addVertex(transform * vec3(1.0f, 0.0f, -1.0f), c);
+    addTriangle(a, b, d);
+    addTriangle(a, d, e);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "image/color.h"
+#include "math/mat4.h"
+#include "math/vec3.h"
+#include <cstdint>
+#include <vector>
+
+// Indexed triangle mesh in world space.
+// Plain arrays so the rasterizer path and the ray caster's BVH read the same
+// vertices: the BVH stores triangle indices into this mesh, never copies of
+// the geometry. Animate by rewriting positions in place, then BVH::refit().
+struct Mesh {
+    std::vector<vec3> positions;
+    std::vector<color> colors;       // Per vertex, same length as positions
+    std::vector<uint32_t> indices;   // 3 per triangle, counter-clockwise front faces
+
+    size_t vertexCount() const { return positions.size(); }
+    size_t triangleCount() const { return indices.size() / 3; }
+
+    void clear();
+
+    // Returns the new vertex's index
+    uint32_t addVertex(const vec3& position, const color& c);
+    void addTriangle(uint32_t a, uint32_t b, uint32_t c);
+
+    // Cube spanning [-1, 1] on each axis, placed by transform (24 vertices,
+    // so every face keeps its own corners)
+    void appendBox(const mat4& transform, const color& c);
+
+    // Square spanning [-1, 1] in the XZ plane facing +Y, placed by transform
+    void appendQuad(const mat4& transform, const color& c);
+};
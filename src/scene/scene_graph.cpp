@@ -0,0 +1,73 @@
+#include "scene_graph.h"
+#include <algorithm>
+
+void SceneGraph::reserve(size_t count) {
+    parents.reserve(count);
+    localTransforms.reserve(count);
+    worldTransforms.reserve(count);
+    dirty.reserve(count);
+}
+
+NodeId SceneGraph::createNode(NodeId parent, const mat4& local) {
+    const NodeId id = static_cast<NodeId>(parents.size());
+    // Parents must already exist - this keeps the arrays topologically sorted
+    if (parent != INVALID_NODE && (parent < 0 || parent >= id)) {
+        return INVALID_NODE;
+    }
+
+    parents.push_back(parent);
+    localTransforms.push_back(local);
+    worldTransforms.push_back(local);
+    dirty.push_back(1);
+
+    if (firstDirty == INVALID_NODE || id < firstDirty) {
+        firstDirty = id;
+    }
+    return id;
+}
+
+void SceneGraph::setLocalTransform(NodeId node, const mat4& local) {
+    localTransforms[node] = local;
+    dirty[node] = 1;
+    if (firstDirty == INVALID_NODE || node < firstDirty) {
+        firstDirty = node;
+    }
+}
+
+SceneGraph::UpdateStats SceneGraph::updateWorldTransforms() {
+    UpdateStats stats;
+    updatedNodes.clear();
+
+    if (firstDirty == INVALID_NODE) {
+        lastStats = stats;
+        return stats;
+    }
+
+    const NodeId count = getNodeCount();
+    const NodeId* parent = parents.data();
+    uint8_t* flags = dirty.data();
+
+    // Parents come before children, so by the time we reach a node its
+    // parent's flag already says whether the parent's world matrix moved.
+    for (NodeId i = firstDirty; i < count; i++) {
+        stats.nodesScanned++;
+        const NodeId p = parent[i];
+        const bool parentChanged = (p != INVALID_NODE) && flags[p];
+        if (!flags[i] && !parentChanged) {
+            continue;
+        }
+        flags[i] = 1;
+        worldTransforms[i] = (p == INVALID_NODE) ? localTransforms[i]
+                                                 : worldTransforms[p] * localTransforms[i];
+        updatedNodes.push_back(i);
+    }
+
+    for (NodeId i : updatedNodes) {
+        flags[i] = 0;
+    }
+
+    stats.nodesUpdated = static_cast<int>(updatedNodes.size());
+    firstDirty = INVALID_NODE;
+    lastStats = stats;
+    return stats;
+}
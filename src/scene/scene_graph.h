@@ -0,0 +1,65 @@
+#pragma once
+
+#include "math/mat4.h"
+#include <cstdint>
+#include <vector>
+
+using NodeId = int32_t;
+constexpr NodeId INVALID_NODE = -1;
+
+// Data-oriented transform hierarchy.
+// Nodes are stored in flat arrays indexed by NodeId. A parent is always
+// created before its children, so the arrays are in topological order and
+// world transforms can be computed in a single forward pass.
+//
+// Only dirty subtrees are recomputed: setLocalTransform() flags the node and
+// updateWorldTransforms() starts scanning at the first flagged node, pushing
+// the flag down to children as it goes. Untouched nodes cost one byte read.
+class SceneGraph {
+public:
+    struct UpdateStats {
+        int nodesScanned = 0;
+        int nodesUpdated = 0;
+    };
+
+    SceneGraph() = default;
+
+    // Reserve storage for a known node count (avoids reallocation while building)
+    void reserve(size_t count);
+
+    // Add a node under parent (INVALID_NODE for a root). Returns its id, or
+    // INVALID_NODE (and adds nothing) if parent is not an existing node.
+    NodeId createNode(NodeId parent = INVALID_NODE, const mat4& local = mat4());
+
+    void setLocalTransform(NodeId node, const mat4& local);
+    const mat4& getLocalTransform(NodeId node) const { return localTransforms[node]; }
+
+    // World transform as of the last updateWorldTransforms()
+    const mat4& getWorldTransform(NodeId node) const { return worldTransforms[node]; }
+
+    // Matrix for transforming this node's normals into world space
+    mat4 getNormalMatrix(NodeId node) const { return worldTransforms[node].inverseTranspose(); }
+
+    NodeId getParent(NodeId node) const { return parents[node]; }
+    int getNodeCount() const { return static_cast<int>(parents.size()); }
+
+    // Nodes whose world transform changed in the last update, in ascending order
+    const std::vector<NodeId>& getUpdatedNodes() const { return updatedNodes; }
+
+    // Recompute world transforms of all dirty nodes and their descendants
+    UpdateStats updateWorldTransforms();
+
+    const UpdateStats& getLastUpdateStats() const { return lastStats; }
+
+private:
+    std::vector<NodeId> parents;
+    std::vector<mat4> localTransforms;
+    std::vector<mat4> worldTransforms;
+
+    // 1 = local transform changed since the last update
+    std::vector<uint8_t> dirty;
+    NodeId firstDirty = INVALID_NODE;     // Lowest dirty index, scan starts here
+
+    std::vector<NodeId> updatedNodes;
+    UpdateStats lastStats;
+};
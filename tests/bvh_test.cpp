@@ -0,0 +1,73 @@
+#include "raytrace/bvh.h"
+#include "scene/mesh.h"
+#include "test_util.h"
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+int main() {
+    Mesh mesh;
+    const color white = color::white();
+    mesh.addTriangle(mesh.addVertex(vec3(0.0f, 0.0f, 0.0f), white),
+                     mesh.addVertex(vec3(1.0f, 0.0f, 0.0f), white),
+                     mesh.addVertex(vec3(0.0f, 1.0f, 0.0f), white));
+    BVH bvh;
+    bvh.build(mesh);
+
+    const vec3 origin(0.25f, 0.25f, 5.0f);
+    const vec3 toward(0.0f, 0.0f, -1.0f);
+    const vec3 away(0.0f, 0.0f, 1.0f);
+    const vec3 beside(3.0f, 3.0f, 5.0f);
+    const vec3 corner(0.9f, 0.9f, 5.0f);  // Inside the bounding box, outside the triangle
+
+    // Unbounded limits must not turn misses into hits
+    for (float limit : { FLT_MAX, std::numeric_limits<float>::infinity(), 1e30f, 10.0f }) {
+        RayHit miss;
+        miss.t = limit;
+        CHECK(!bvh.intersect(origin, away, miss));
+        CHECK(miss.triangle == RAY_NO_HIT);
+        CHECK(miss.t == limit);
+        RayHit side;
+        side.t = limit;
+        CHECK(!bvh.intersect(beside, toward, side));
+        RayHit inBox;
+        inBox.t = limit;
+        CHECK(!bvh.intersect(corner, toward, inBox));
+        CHECK(inBox.triangle == RAY_NO_HIT);
+        CHECK(!bvh.occluded(corner, toward, limit));
+        CHECK(!bvh.occluded(origin, away, limit));
+        CHECK(!bvh.occluded(beside, toward, limit));
+
+        RayHit hit;
+        hit.t = limit;
+        CHECK(bvh.intersect(origin, toward, hit));
+        CHECK(hit.triangle == 0);
+        CHECK(std::fabs(hit.t - 5.0f) < 1e-5f);
+        CHECK(std::fabs(hit.u - 0.25f) < 1e-5f && std::fabs(hit.v - 0.25f) < 1e-5f);
+        CHECK(bvh.occluded(origin, toward, limit));
+
+        // Packets: lanes 0-3 point at the triangle, 4-7 away from it
+        vec3 origins[8], directions[8];
+        for (int i = 0; i < 8; i++) {
+            origins[i] = origin;
+            directions[i] = i < 4 ? toward : away;
+        }
+        RayPacket8 packet;
+        packet.origin = vec3x8::load(origins);
+        packet.direction = vec3x8::load(directions);
+        packet.tMax = simd::set1(limit);
+        PacketHit8 hits;
+        bvh.intersect8(packet, hits);
+        for (int i = 0; i < 8; i++) {
+            CHECK(hits.triangle[i] == (i < 4 ? 0u : RAY_NO_HIT));
+        }
+        CHECK(bvh.occluded8(packet) == 0x0F);
+    }
+
+    // The limit is exclusive and still respected
+    RayHit shortRay;
+    shortRay.t = 4.0f;
+    CHECK(!bvh.intersect(origin, toward, shortRay));
+    CHECK(!bvh.occluded(origin, toward, 4.0f));
+    return TestFailures();
+}
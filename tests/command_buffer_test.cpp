@@ -0,0 +1,131 @@
+#include "core/framebuffer.h"
+#include "image/primitives.h"
+#include "rendering/command_buffer.h"
+#include "test_util.h"
+#include <cstring>
+
+namespace {
+    void recordQuad(CommandBuffer& commands, float x0, float y0, float x1, float y1, float depth, color c) {
+        commands.setDepth(depth);
+        commands.fillTriangle(x0, y0, x1, y0, x1, y1, c);
+        commands.fillTriangle(x0, y0, x1, y1, x0, y1, c);
+    }
+
+    // Two overlapping opaque quads: the nearer one must cover the overlap
+    // whichever order they were recorded in
+    void checkOverlap(bool nearFirst) {
+        const color nearColor = color::red();
+        const color farColor = color::blue();
+        CommandBuffer commands;
+        commands.clear(0xFF000000);
+        if (nearFirst) {
+            recordQuad(commands, 8, 8, 40, 40, 1.0f, nearColor);
+            recordQuad(commands, 24, 24, 56, 56, 2.0f, farColor);
+        } else {
+            recordQuad(commands, 24, 24, 56, 56, 2.0f, farColor);
+            recordQuad(commands, 8, 8, 40, 40, 1.0f, nearColor);
+        }
+
+        Framebuffer direct(64, 64);
+        commands.execute(direct);
+        CHECK(direct.getPixel(32, 32) == nearColor.toUint32());
+        CHECK(direct.getPixel(12, 12) == nearColor.toUint32());
+        CHECK(direct.getPixel(50, 50) == farColor.toUint32());
+
+        Framebuffer queued(64, 64);
+        RenderQueue queue;
+        queue.submit(commands);
+        queue.execute(queued, nullptr, 16);
+        CHECK(queued.getPixel(32, 32) == nearColor.toUint32());
+        CHECK(queued.getPixel(50, 50) == farColor.toUint32());
+    }
+
+    // Merging interleaves buffers by key, keeps submission order on ties, and
+    // stops allocating once the queue's arena has seen a frame this size
+    void checkMerge() {
+        CommandBuffer first, second;
+        first.setLayer(1);
+        first.clear(1);
+        second.setLayer(0);
+        second.clear(2);
+        second.setLayer(1);
+        second.clear(3);
+        second.setLayer(2);
+        second.clear(4);
+
+        RenderQueue queue;
+        queue.submit(first);
+        queue.submit(second);
+        for (int frame = 0; frame < 3; frame++) {
+            const ArenaSpan<const DrawCommand*> merged = queue.merge();
+            CHECK(merged.size() == 4);
+            CHECK(merged[0]->colors[0] == 2);
+            CHECK(merged[1]->colors[0] == 1);
+            CHECK(merged[2]->colors[0] == 3);
+            CHECK(merged[3]->colors[0] == 4);
+            if (frame > 0) {
+                CHECK(queue.getMergeStats().overflowBytes == 0);
+            }
+        }
+
+        queue.reset();
+        CHECK(queue.merge().empty());
+    }
+
+    // A recorded frame replayed in bands matches the immediate-mode
+    // functions it mirrors, pixel for pixel
+    void checkMatchesImmediate() {
+        Framebuffer expected(64, 48), actual(64, 48);
+        FillWithGradient(expected);
+        FillTriangle(4.25f, 3.5f, 40.75f, 9.0f, 12.5f, 30.125f, color::blue(), expected);
+        FillTriangle(30.0f, 10.0f, 60.5f, 44.0f, 20.0f, 40.0f, color::red(), color::green(), color::blue(), expected);
+        DrawTriangle(2, 40, 50, 2, 62, 47, color::cyan(), expected);
+
+        CommandBuffer commands;
+        commands.fillWithGradient();
+        commands.setLayer(1);
+        commands.fillTriangle(4.25f, 3.5f, 40.75f, 9.0f, 12.5f, 30.125f, color::blue());
+        commands.setLayer(2);
+        commands.fillTriangle(30.0f, 10.0f, 60.5f, 44.0f, 20.0f, 40.0f, color::red(), color::green(), color::blue());
+        commands.setLayer(3);
+        commands.drawTriangle(2, 40, 50, 2, 62, 47, color::cyan());
+        RenderQueue queue;
+        queue.submit(commands);
+        queue.execute(actual, nullptr, 7);
+        CHECK(std::memcmp(expected.data(), actual.data(), 64 * 48 * 4) == 0);
+    }
+
+    // Lines replayed band by band hit exactly the pixels DrawLine does,
+    // including lines that start or end off screen
+    void checkBandedLines() {
+        const int lines[][4] = {
+            { 3, 5, 60, 17 }, { 60, 17, 3, 5 }, { 10, 2, 14, 45 }, { 14, 45, 10, 2 },
+            { -20, 30, 90, 41 }, { 31, -15, 25, 80 }, { 0, 0, 47, 47 }, { 47, 0, 0, 47 },
+            { 5, 12, 40, 12 }, { 22, 1, 22, 46 }, { 7, 7, 7, 7 }, { -30, -30, -5, -2 },
+        };
+        for (const auto& l : lines) {
+            Framebuffer expected(48, 48), actual(48, 48);
+            expected.clear(0);
+            actual.clear(0);
+            DrawLine(l[0], l[1], l[2], l[3], color::white(), expected);
+
+            CommandBuffer commands;
+            commands.drawLine(l[0], l[1], l[2], l[3], color::white());
+            for (int bandHeight : { 1, 5, 16, 48 }) {
+                RenderQueue queue;
+                queue.submit(commands);
+                queue.execute(actual, nullptr, bandHeight);
+                CHECK(std::memcmp(expected.data(), actual.data(), 48 * 48 * 4) == 0);
+            }
+        }
+    }
+}
+
+int main() {
+    checkOverlap(true);
+    checkOverlap(false);
+    checkMerge();
+    checkMatchesImmediate();
+    checkBandedLines();
+    return TestFailures();
+}
@@ -0,0 +1,284 @@
+#include "image/compressed_texture.h"
+#include "core/framebuffer.h"
+#include "test_util.h"
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+namespace {
+    struct RGBA {
+        int r, g, b, a;
+    };
+
+    TGAImage makeImage(int width, int height, int bpp, const std::function<RGBA(int, int)>& texel) {
+        TGAImage image(width, height, bpp);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                const RGBA t = texel(x, y);
+                TGAColor c;
+                c.bgra[0] = uint8_t(t.b);
+                c.bgra[1] = uint8_t(t.g);
+                c.bgra[2] = uint8_t(t.r);
+                c.bgra[3] = uint8_t(t.a);
+                c.bytespp = uint8_t(bpp);
+                if (bpp == 1) c.bgra[0] = uint8_t(t.r);
+                image.set(x, y, c);
+            }
+        }
+        return image;
+    }
+
+    uint32_t decodedTexel(const CompressedTexture& texture, int x, int y) {
+        uint32_t texels[16];
+        texture.decodeBlock(x / 4, y / 4, texels);
+        return texels[(y & 3) * 4 + (x & 3)];
+    }
+
+    // Largest per-channel difference between the image and its decoded texels
+    int maxError(const CompressedTexture& texture, const std::function<RGBA(int, int)>& texel, bool withAlpha) {
+        int worst = 0;
+        for (int y = 0; y < texture.height(); y++) {
+            for (int x = 0; x < texture.width(); x++) {
+                const RGBA expected = texel(x, y);
+                const uint32_t got = decodedTexel(texture, x, y);
+                worst = std::max(worst, std::abs(getRed(got) - expected.r));
+                worst = std::max(worst, std::abs(getGreen(got) - expected.g));
+                worst = std::max(worst, std::abs(getBlue(got) - expected.b));
+                worst = std::max(worst, std::abs(getAlpha(got) - (withAlpha ? expected.a : 255)));
+            }
+        }
+        return worst;
+    }
+
+    int maxAlphaError(const CompressedTexture& texture, const std::function<RGBA(int, int)>& texel) {
+        int worst = 0;
+        for (int y = 0; y < texture.height(); y++) {
+            for (int x = 0; x < texture.width(); x++) {
+                worst = std::max(worst, std::abs(getAlpha(decodedTexel(texture, x, y)) - texel(x, y).a));
+            }
+        }
+        return worst;
+    }
+
+    CompressedTexture encoded(const TGAImage& image, BlockFormat format) {
+        CompressedTexture texture;
+        CHECK(texture.encode(image, format));
+        return texture;
+    }
+
+    // Solid blocks come back within RGB565 rounding; colors that 565 can
+    // represent come back exactly
+    void checkSolid() {
+        const auto solid = [](int, int) { return RGBA{ 200, 100, 50, 255 }; };
+        const CompressedTexture bc1 = encoded(makeImage(8, 8, TGAImage::RGB, solid), BlockFormat::BC1);
+        CHECK(bc1.format() == BlockFormat::BC1 && bc1.sizeInBytes() == 4 * 8);
+        CHECK(maxError(bc1, solid, false) <= 4);
+
+        const auto exact = [](int, int) { return RGBA{ 255, 0, 255, 255 }; };
+        CHECK(maxError(encoded(makeImage(4, 4, TGAImage::RGB, exact), BlockFormat::BC1), exact, false) == 0);
+
+        const auto translucent = [](int, int) { return RGBA{ 255, 255, 255, 77 }; };
+        const CompressedTexture bc3 = encoded(makeImage(4, 4, TGAImage::RGBA, translucent), BlockFormat::BC3);
+        CHECK(bc3.sizeInBytes() == 16);
+        CHECK(maxError(bc3, translucent, true) == 0);
+
+        // Grayscale input expands to equal channels
+        const auto gray = [](int, int) { return RGBA{ 132, 132, 132, 255 }; };
+        CHECK(maxError(encoded(makeImage(4, 4, TGAImage::GRAYSCALE, gray), BlockFormat::BC1), gray, false) <= 4);
+    }
+
+    // Two colors per block: the endpoints are pulled 1/16 of the range in,
+    // plus 565 rounding
+    void checkTwoColor() {
+        const auto farApart = [](int x, int y) {
+            return (x + y) % 2 ? RGBA{ 255, 0, 0, 255 } : RGBA{ 0, 0, 255, 255 };
+        };
+        const CompressedTexture wide = encoded(makeImage(8, 8, TGAImage::RGB, farApart), BlockFormat::BC1);
+        CHECK(maxError(wide, farApart, false) <= 255 / 16 + 8);
+
+        const auto close = [](int x, int) {
+            return x < 2 ? RGBA{ 100, 150, 200, 255 } : RGBA{ 124, 162, 176, 255 };
+        };
+        const CompressedTexture near = encoded(makeImage(4, 4, TGAImage::RGB, close), BlockFormat::BC1);
+        CHECK(maxError(near, close, false) <= 6);
+
+        // The two colors stay distinct and each keeps its side
+        const uint32_t left = decodedTexel(near, 0, 0), right = decodedTexel(near, 3, 3);
+        CHECK(left != right && getRed(left) < getRed(right) && getBlue(left) > getBlue(right));
+    }
+
+    // BC3 alpha: 8-level ramps per block, exact at the block's extremes
+    void checkAlphaRamps() {
+        const auto horizontal = [](int x, int) { return RGBA{ 40, 80, 120, x * 17 }; };
+        const TGAImage image = makeImage(16, 4, TGAImage::RGBA, horizontal);
+        CHECK(CompressedTexture::pickFormat(image) == BlockFormat::BC3);
+        const CompressedTexture bc3 = encoded(image, BlockFormat::BC3);
+        CHECK(maxAlphaError(bc3, horizontal) <= 4);
+        CHECK(getAlpha(decodedTexel(bc3, 0, 0)) == 0 && getAlpha(decodedTexel(bc3, 15, 3)) == 255);
+        CHECK(maxError(bc3, horizontal, true) <= 4);
+
+        // The whole 0..255 range inside one block
+        const auto steep = [](int x, int y) { return RGBA{ 255, 255, 255, (y * 4 + x) * 17 }; };
+        const CompressedTexture full = encoded(makeImage(4, 4, TGAImage::RGBA, steep), BlockFormat::BC3);
+        CHECK(maxAlphaError(full, steep) <= 255 / 14 + 1);
+        CHECK(getAlpha(decodedTexel(full, 0, 0)) == 0 && getAlpha(decodedTexel(full, 3, 3)) == 255);
+
+        // BC1 drops alpha; opaque images pick BC1
+        CHECK(getAlpha(decodedTexel(encoded(image, BlockFormat::BC1), 0, 0)) == 255);
+        CHECK(CompressedTexture::pickFormat(makeImage(4, 4, TGAImage::RGB, horizontal)) == BlockFormat::BC1);
+    }
+
+    // 7x5: partial blocks on the right and bottom repeat the last column/row.
+    // A gradient along one color direction is what BC1's line fit is built for.
+    void checkEdgeBlocks() {
+        const auto smooth = [](int x, int y) {
+            const int t = x + y;
+            return RGBA{ 40 + 8 * t, 30 + 6 * t, 200 - 9 * t, 255 - 12 * t };
+        };
+        for (BlockFormat format : { BlockFormat::BC1, BlockFormat::BC3 }) {
+            const CompressedTexture texture = encoded(makeImage(7, 5, TGAImage::RGBA, smooth), format);
+            CHECK(texture.width() == 7 && texture.height() == 5);
+            CHECK(texture.blocksX() == 2 && texture.blocksY() == 2);
+            CHECK(texture.sizeInBytes() == size_t(4 * texture.bytesPerBlock()));
+            // About half a palette step (range 54 per block) plus 565 rounding
+            CHECK(maxError(texture, smooth, format == BlockFormat::BC3) <= 10);
+
+            uint32_t corner[16];
+            texture.decodeBlock(1, 1, corner);
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    const int sx = std::min(4 + x, 6), sy = std::min(4 + y, 4);
+                    CHECK(corner[y * 4 + x] == decodedTexel(texture, sx, sy));
+                }
+            }
+
+            // Sampling clamps to the real texels, never the padding
+            TextureSampler sampler(texture);
+            CHECK(sampler.fetch(100, 100) == decodedTexel(texture, 6, 4));
+            CHECK(sampler.fetch(-3, 2) == decodedTexel(texture, 0, 2));
+            CHECK(sampler.sampleNearest(1.0f, 1.0f) == decodedTexel(texture, 6, 4));
+        }
+
+        CompressedTexture empty;
+        CHECK(!empty.encode(TGAImage(), BlockFormat::BC1));
+    }
+
+    bool sameBlocks(const CompressedTexture& a, const CompressedTexture& b) {
+        if (a.width() != b.width() || a.height() != b.height() || a.format() != b.format() ||
+            a.sizeInBytes() != b.sizeInBytes()) {
+            return false;
+        }
+        for (int by = 0; by < a.blocksY(); by++) {
+            for (int bx = 0; bx < a.blocksX(); bx++) {
+                uint32_t ta[16], tb[16];
+                a.decodeBlock(bx, by, ta);
+                b.decodeBlock(bx, by, tb);
+                for (int i = 0; i < 16; i++) {
+                    if (ta[i] != tb[i]) return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    long fileSize(const char* path) {
+        FILE* file = std::fopen(path, "rb");
+        if (!file) return -1;
+        std::fseek(file, 0, SEEK_END);
+        const long size = std::ftell(file);
+        std::fclose(file);
+        return size;
+    }
+
+    // DTEX files: 16-byte header plus the raw blocks, rejected when damaged
+    void checkSaveLoad() {
+        const char* path = "compressed_texture_test.dtex";
+        const auto pattern = [](int x, int y) { return RGBA{ x * 20, y * 25, (x * y) % 256, 128 + x }; };
+        for (BlockFormat format : { BlockFormat::BC1, BlockFormat::BC3 }) {
+            const CompressedTexture original = encoded(makeImage(11, 9, TGAImage::RGBA, pattern), format);
+            CHECK(original.save(path));
+            CHECK(fileSize(path) == long(16 + original.sizeInBytes()));
+
+            CompressedTexture loaded;
+            CHECK(loaded.load(path));
+            CHECK(sameBlocks(loaded, original));
+        }
+
+        // Truncated data and a wrong magic both fail to load
+        {
+            FILE* file = std::fopen(path, "r+b");
+            CHECK(file != nullptr);
+            if (file) {
+                std::fputc('X', file);
+                std::fclose(file);
+            }
+            CompressedTexture damaged;
+            CHECK(!damaged.load(path));
+        }
+        const CompressedTexture small = encoded(makeImage(8, 8, TGAImage::RGB, pattern), BlockFormat::BC1);
+        CHECK(small.save(path));
+        CHECK(std::remove(path) == 0);
+        CompressedTexture missing;
+        CHECK(!missing.load(path));
+
+        // loadCached writes the cache, and later loads work from it alone
+        const char* tgaPath = "compressed_texture_test.tga";
+        const TGAImage image = makeImage(12, 6, TGAImage::RGBA, pattern);
+        CHECK(image.write_tga_file(tgaPath));
+        CompressedTexture first;
+        CHECK(first.loadCached(tgaPath, path));
+        CHECK(first.format() == BlockFormat::BC3 && fileSize(path) == long(16 + first.sizeInBytes()));
+        std::remove(tgaPath);
+        CompressedTexture second;
+        CHECK(second.loadCached(tgaPath, path));
+        CHECK(sameBlocks(second, first));
+        std::remove(path);
+    }
+
+    // The sampler decodes each block once per run of nearby accesses
+    void checkSamplerCache() {
+        const auto pattern = [](int x, int y) { return RGBA{ x * 8, y * 8, 128, 255 }; };
+        const CompressedTexture texture = encoded(makeImage(32, 32, TGAImage::RGB, pattern), BlockFormat::BC1);
+        TextureSampler sampler(texture);
+
+        // One block: a single decode
+        for (int i = 0; i < 16; i++) {
+            CHECK(sampler.fetch(i & 3, i >> 2) == decodedTexel(texture, i & 3, i >> 2));
+        }
+        CHECK(sampler.getMisses() == 1 && sampler.getHits() == 15);
+
+        // 8x8 blocks fit the cache: a full scan decodes each block once,
+        // a second scan decodes nothing
+        for (int pass = 0; pass < 2; pass++) {
+            for (int y = 0; y < 32; y++) {
+                for (int x = 0; x < 32; x++) {
+                    sampler.fetch(x, y);
+                }
+            }
+        }
+        CHECK(sampler.getMisses() == 64);
+        CHECK(sampler.getHits() == 15 + 2 * 32 * 32 - 63);
+
+        // Bilinear taps inside one block share it
+        sampler.invalidate();
+        const uint64_t missesBefore = sampler.getMisses(), hitsBefore = sampler.getHits();
+        sampler.sampleBilinear(10.0f / 32.0f, 22.0f / 32.0f);
+        CHECK(sampler.getMisses() - missesBefore == 1 && sampler.getHits() - hitsBefore == 3);
+
+        // Halfway between two texels gives their average
+        const uint32_t a = decodedTexel(texture, 9, 22), b = decodedTexel(texture, 10, 22);
+        const uint32_t mid = sampler.sampleBilinear(10.0f / 32.0f, 22.5f / 32.0f);
+        CHECK(std::abs(getRed(mid) - (getRed(a) + getRed(b)) / 2) <= 1);
+        CHECK(std::abs(getGreen(mid) - (getGreen(a) + getGreen(b)) / 2) <= 1);
+    }
+}
+
+int main() {
+    checkSolid();
+    checkTwoColor();
+    checkAlphaRamps();
+    checkEdgeBlocks();
+    checkSaveLoad();
+    checkSamplerCache();
+    return TestFailures();
+}
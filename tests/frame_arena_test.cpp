@@ -0,0 +1,126 @@
+#include "core/frame_arena.h"
+#include "test_util.h"
+#include <cstdint>
+
+namespace {
+    bool isAligned(const void* p, size_t alignment) {
+        return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+    }
+
+    struct alignas(32) Wide {
+        float lanes[8];
+    };
+}
+
+int main() {
+    // Alignment is honoured in the primary block, whatever came before
+    {
+        LinearArena arena(4096);
+        CHECK(isAligned(&arena, 64));
+        arena.allocate(1, 1);
+        CHECK(isAligned(arena.allocate(8, 8), 8));
+        arena.allocate(3, 1);
+        CHECK(isAligned(arena.allocate(16, 64), 64));
+        arena.allocate(5, 1);
+        CHECK(isAligned(arena.create<Wide>(), alignof(Wide)));
+        const ArenaSpan<uint16_t> span = arena.allocSpan<uint16_t>(7);
+        CHECK(span.size() == 7 && isAligned(span.data(), alignof(uint16_t)));
+        CHECK(arena.allocSpan<int>(0).empty());
+
+        const int values[3] = { 4, 5, 6 };
+        const ArenaSpan<int> copy = arena.copySpan(values, 3);
+        CHECK(copy[0] == 4 && copy[1] == 5 && copy[2] == 6);
+        CHECK(*arena.create<int>(42) == 42);
+
+        const ArenaStats stats = arena.stats();
+        CHECK(stats.allocations == 9);  // Empty spans don't allocate
+        CHECK(stats.capacity == 4096);
+        CHECK(stats.overflowBytes == 0);
+        CHECK(stats.bytesUsed == arena.bytesUsed() && stats.bytesUsed > 0 && stats.bytesUsed <= 4096);
+    }
+
+    // A frame larger than the primary block spills into overflow blocks,
+    // then reset() grows the block to the high-water mark
+    {
+        LinearArena arena(1024);
+        char* first = static_cast<char*>(arena.allocate(1000, 8));
+        char* spilled = static_cast<char*>(arena.allocate(1000, 64));
+        CHECK(isAligned(spilled, 64));
+        CHECK(spilled < first || spilled >= first + 1024);
+        for (int i = 0; i < 100; i++) {
+            CHECK(isAligned(arena.allocate(700, 16), 16));
+        }
+
+        ArenaStats stats = arena.stats();
+        CHECK(stats.allocations == 102);
+        CHECK(stats.capacity == 1024);
+        CHECK(stats.overflowBytes >= 1000 + 100 * 700);
+        CHECK(stats.bytesUsed >= 2000 + 100 * 700);
+        const size_t frameBytes = stats.bytesUsed;
+        CHECK(stats.highWaterMark == frameBytes);
+
+        arena.reset();
+        stats = arena.stats();
+        CHECK(stats.bytesUsed == 0 && stats.allocations == 0 && stats.overflowBytes == 0);
+        CHECK(stats.highWaterMark == frameBytes);
+        CHECK(stats.capacity >= frameBytes);
+
+        // The same frame again fits the grown block
+        arena.allocate(1000, 8);
+        arena.allocate(1000, 64);
+        for (int i = 0; i < 100; i++) {
+            arena.allocate(700, 16);
+        }
+        CHECK(arena.stats().overflowBytes == 0);
+        const size_t grownCapacity = arena.stats().capacity;
+
+        // Smaller frames don't shrink it, and the high-water mark stays
+        arena.reset();
+        arena.allocate(10, 8);
+        arena.reset();
+        CHECK(arena.stats().capacity == grownCapacity);
+        CHECK(arena.stats().highWaterMark >= frameBytes);
+    }
+
+    // An arena created empty starts in overflow and settles after one reset
+    {
+        LinearArena arena;
+        CHECK(arena.stats().capacity == 0);
+        CHECK(isAligned(arena.allocate(100, 32), 32));
+        CHECK(arena.stats().overflowBytes >= 100);
+        arena.reset();
+        CHECK(arena.stats().capacity >= 100);
+        arena.allocate(100, 32);
+        CHECK(arena.stats().overflowBytes == 0);
+    }
+
+    // FrameArena: one slot per thread, stats summed
+    {
+        FrameArena frame(3, 256);
+        CHECK(frame.getThreadCount() == 3);
+        for (int t = 0; t < 3; t++) {
+            CHECK(isAligned(&frame.local(t), 64));
+        }
+        const ArenaSpan<float> a = frame.allocSpan<float>(0, 16);
+        const ArenaSpan<float> b = frame.allocSpan<float>(1, 16);
+        CHECK(a.data() != b.data());
+        frame.allocSpan<char>(2, 512);  // Overflows thread 2 only
+
+        ArenaStats total = frame.stats();
+        CHECK(total.allocations == 3);
+        CHECK(total.capacity == 3 * 256);
+        CHECK(total.bytesUsed == frame.stats(0).bytesUsed + frame.stats(1).bytesUsed + frame.stats(2).bytesUsed);
+        CHECK(frame.stats(0).overflowBytes == 0 && frame.stats(2).overflowBytes >= 512);
+
+        frame.reset();
+        total = frame.stats();
+        CHECK(total.bytesUsed == 0 && total.allocations == 0);
+        CHECK(frame.stats(0).capacity == 256);
+        CHECK(frame.stats(2).capacity >= 512);
+        CHECK(total.highWaterMark >= 2 * 64 + 512);
+
+        // Zero threads still gets the main thread's slot
+        CHECK(FrameArena(0, 64).getThreadCount() == 1);
+    }
+    return TestFailures();
+}
@@ -0,0 +1,72 @@
+#include "core/framebuffer.h"
+#include "test_util.h"
+#include <utility>
+
+int main() {
+    // Moving an owned framebuffer keeps the pixels and empties the source
+    Framebuffer owned(4, 3);
+    owned.setPixel(1, 1, 0xFF112233);
+    Framebuffer moved(std::move(owned));
+    CHECK(moved.getWidth() == 4 && moved.getHeight() == 3);
+    CHECK(moved.getPixel(1, 1) == 0xFF112233);
+    CHECK(!moved.isExternal());
+    CHECK(owned.getWidth() == 0 && owned.getHeight() == 0);
+    CHECK(!owned.isExternal());
+    CHECK(owned.data() == nullptr);
+
+    // Moving an external framebuffer: the target aliases the memory, the
+    // source no longer claims it
+    uint32_t memory[4 * 4] = {};
+    Framebuffer external(4, 4, memory);
+    Framebuffer target(2, 2);
+    target = std::move(external);
+    CHECK(target.isExternal());
+    CHECK(target.data() == memory);
+    CHECK(!external.isExternal());
+    CHECK(external.data() == nullptr);
+    external.clear();  // Harmless on an empty framebuffer
+
+    // Owned framebuffers resize; external ones refuse and keep their size
+    Framebuffer scaled(8, 8);
+    CHECK(scaled.resize(4, 6));
+    CHECK(scaled.getWidth() == 4 && scaled.getHeight() == 6);
+    CHECK(!target.resize(2, 2));
+    CHECK(target.getWidth() == 4 && target.getHeight() == 4);
+    CHECK(target.data() == memory);
+    CHECK(target.resize(4, 4));  // Same size is fine
+
+    // Shrinking an owned framebuffer to nothing and growing it back: it stays
+    // owned, and copies of the empty state don't alias anything
+    Framebuffer collapsing(5, 5);
+    CHECK(collapsing.resize(0, 0));
+    CHECK(!collapsing.isExternal());
+    const Framebuffer emptyCopy(collapsing);
+    CHECK(!emptyCopy.isExternal() && emptyCopy.getWidth() == 0);
+    Framebuffer emptyAssigned(3, 3);
+    emptyAssigned = collapsing;
+    CHECK(!emptyAssigned.isExternal() && emptyAssigned.getWidth() == 0);
+    CHECK(emptyAssigned.resize(2, 2));
+    CHECK(collapsing.resize(7, 3));
+    CHECK(collapsing.getWidth() == 7 && collapsing.getHeight() == 3);
+    collapsing.clear(0xFF00FF00);
+    CHECK(collapsing.getPixel(6, 2) == 0xFF00FF00);
+    CHECK(collapsing.resize(0, 0) && collapsing.resize(2, 9));
+
+    // Copies of an owned framebuffer own their own pixels
+    Framebuffer copied(collapsing);
+    CHECK(!copied.isExternal() && copied.data() != collapsing.data());
+
+    // Starting empty works the same way
+    Framebuffer startsEmpty(0, 0);
+    CHECK(!startsEmpty.isExternal());
+    CHECK(startsEmpty.resize(3, 2));
+    CHECK(startsEmpty.getWidth() == 3 && startsEmpty.data() != nullptr);
+
+    // Copies of an external framebuffer alias its memory and stay external
+    uint32_t shared[2 * 2] = {};
+    const Framebuffer view(2, 2, shared);
+    Framebuffer alias(view);
+    CHECK(alias.isExternal() && alias.data() == shared);
+    CHECK(!alias.resize(3, 3));
+    return TestFailures();
+}
@@ -0,0 +1,54 @@
+#include "core/hdr_buffer.h"
+#include "test_util.h"
+#include <limits>
+
+namespace {
+    // Width 5: pixels 0-3 go through the 4-wide SIMD loop, pixel 4 through
+    // the scalar tail. Both must agree on Inf and NaN and stay in the table.
+    void checkNonFinite(HDRFormat format, ToneMapOperator op) {
+        const float inf = std::numeric_limits<float>::infinity();
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        HDRBuffer hdr(5, 3, format);
+        for (int x = 0; x < 5; x++) {
+            hdr.setPixel(x, 0, color(inf, 0.5f, 0.5f, 1.0f));
+            hdr.setPixel(x, 1, color(nan, 0.5f, nan, nan));
+            hdr.setPixel(x, 2, color(0.25f, 0.5f, 0.5f, 1.0f));
+        }
+        if (format == HDRFormat::Float16) {
+            // Accumulating past the half range overflows to Inf
+            hdr.addPixel(1, 2, color(70000.0f, 0.0f, 0.0f, 0.0f));
+            hdr.addPixel(4, 2, color(70000.0f, 0.0f, 0.0f, 0.0f));
+        }
+
+        Framebuffer out(5, 3);
+        ToneMapSettings settings;
+        settings.op = op;
+        ToneMap(hdr, out, settings);
+
+        for (int x = 0; x < 4; x++) {
+            CHECK(out.getPixel(x, 0) == out.getPixel(4, 0));
+            CHECK(out.getPixel(x, 1) == out.getPixel(4, 1));
+        }
+        CHECK(getRed(out.getPixel(4, 0)) == 255);   // Inf saturates
+        CHECK(getRed(out.getPixel(4, 1)) == 0);     // NaN goes dark
+        CHECK(getBlue(out.getPixel(4, 1)) == 0);
+        CHECK(getAlpha(out.getPixel(4, 1)) == 0);
+        if (format == HDRFormat::Float16) {
+            CHECK(out.getPixel(1, 2) == out.getPixel(4, 2));
+            CHECK(getRed(out.getPixel(4, 2)) == 255);
+        }
+    }
+}
+
+int main() {
+    for (HDRFormat format : { HDRFormat::Float32, HDRFormat::Float16 }) {
+        for (ToneMapOperator op : { ToneMapOperator::Clamp, ToneMapOperator::Reinhard, ToneMapOperator::ACES }) {
+            checkNonFinite(format, op);
+        }
+    }
+
+    CHECK(LinearToSRGB(std::numeric_limits<float>::infinity()) == 255);
+    CHECK(LinearToSRGB(std::numeric_limits<float>::quiet_NaN()) == 0);
+    CHECK(LinearToSRGB(-1.0f) == 0);
+    return TestFailures();
+}
@@ -0,0 +1,248 @@
+#include "rendering/oit_buffer.h"
+#include "core/thread_pool.h"
+#include "test_util.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace {
+    constexpr int WIDTH = 37;
+    constexpr int HEIGHT = 29;
+    constexpr uint32_t BACKGROUND = 0xFF204060;
+
+    struct Sample {
+        float depth;
+        uint32_t color;
+    };
+
+    // The straightforward version: every pixel's fragments in a vector,
+    // sorted near to far (ties by color), the nearest `cap` blended back to front
+    struct Reference {
+        std::vector<std::vector<Sample>> pixels = std::vector<std::vector<Sample>>(WIDTH * HEIGHT);
+
+        void add(int x, int y, float depth, uint32_t color) { pixels[y * WIDTH + x].push_back({ depth, color }); }
+
+        Framebuffer resolve(size_t cap) const {
+            Framebuffer out(WIDTH, HEIGHT);
+            out.clear(BACKGROUND);
+            for (int i = 0; i < WIDTH * HEIGHT; i++) {
+                std::vector<Sample> sorted = pixels[i];
+                std::sort(sorted.begin(), sorted.end(), [](const Sample& a, const Sample& b) {
+                    return a.depth < b.depth || (a.depth == b.depth && a.color < b.color);
+                });
+                sorted.resize(std::min(sorted.size(), cap));
+                uint32_t pixel = BACKGROUND;
+                for (auto it = sorted.rbegin(); it != sorted.rend(); ++it) {
+                    pixel = blendOver(pixel, it->color);
+                }
+                out.data()[i] = pixel;
+            }
+            return out;
+        }
+    };
+
+    struct Random {
+        uint32_t state;
+        uint32_t next() {
+            state = state * 1664525u + 1013904223u;
+            return state >> 8;
+        }
+        int below(int n) { return static_cast<int>(next() % uint32_t(n)); }
+        uint32_t translucent() { return (uint32_t(32 + below(192)) << 24) | (next() & 0xFFFFFF); }
+    };
+
+    bool samePixels(const Framebuffer& a, const Framebuffer& b) {
+        return std::memcmp(a.data(), b.data(), sizeof(uint32_t) * WIDTH * HEIGHT) == 0;
+    }
+
+    Framebuffer background() {
+        Framebuffer framebuffer(WIDTH, HEIGHT);
+        framebuffer.clear(BACKGROUND);
+        return framebuffer;
+    }
+
+    // Random fragment soups, inserted from several threads, resolve exactly
+    // like a CPU sort of each pixel's fragments
+    void checkAgainstReference(ThreadPool* pool) {
+        OITConfig config;
+        config.initialFragments = 1 << 14;
+        config.tileSize = 8;
+        OITBuffer oit(WIDTH, HEIGHT, config);
+        Reference reference;
+
+        struct Insert {
+            int x, y;
+            float depth;
+            uint32_t color;
+        };
+        std::vector<Insert> inserts;
+        Random random{ 7 };
+        for (int i = 0; i < 4000; i++) {
+            const int x = random.below(WIDTH), y = random.below(HEIGHT);
+            if (reference.pixels[y * WIDTH + x].size() >= 12) continue;   // Stay under the cap of 16
+            // Coarse depths so equal depths (resolved by color) are common
+            const float depth = float(random.below(40)) * 0.25f;
+            inserts.push_back({ x, y, depth, random.translucent() });
+            reference.add(x, y, depth, inserts.back().color);
+        }
+
+        // Translucent triangles on top, fragments computed the same way
+        const float tx[3] = { 2.5f, 33.0f, 12.25f }, ty[3] = { 1.0f, 9.5f, 27.0f }, tz[3] = { 0.5f, 8.0f, 3.0f };
+        const color tc[3] = { color(1, 0, 0, 0.5f), color(0, 1, 0, 0.25f), color(0, 0, 1, 0.75f) };
+        RasterizeTriangle(tx[0], ty[0], tx[1], ty[1], tx[2], ty[2], RasterRect{ 0, 0, WIDTH, HEIGHT },
+                          [&](int x, int y, float l0, float l1, float l2) {
+            reference.add(x, y, tz[0] * l0 + tz[1] * l1 + tz[2] * l2, (tc[0] * l0 + tc[1] * l1 + tc[2] * l2).toUint32());
+        });
+
+        Framebuffer expected = reference.resolve(16);
+        for (int frame = 0; frame < 2; frame++) {
+            oit.reset();
+            // CHECK isn't thread-safe: count refusals and check on this thread
+            const int chunks = 8;
+            std::atomic<int> refused{ 0 };
+            auto insertChunk = [&](int chunk, int) {
+                for (size_t i = chunk; i < inserts.size(); i += chunks) {
+                    if (!oit.insert(inserts[i].x, inserts[i].y, inserts[i].depth, inserts[i].color)) refused++;
+                }
+            };
+            if (pool) {
+                pool->parallelFor(chunks, insertChunk);
+            } else {
+                for (int chunk = 0; chunk < chunks; chunk++) insertChunk(chunk, 0);
+            }
+            CHECK(refused == 0);
+            oit.insertTriangle(tx, ty, tz, tc);
+
+            Framebuffer framebuffer = background();
+            oit.resolve(framebuffer, pool);
+            CHECK(samePixels(framebuffer, expected));
+
+            const OITStats stats = oit.getStats();
+            CHECK(stats.fragmentsDropped == 0 && stats.fragmentsDiscarded == 0);
+            CHECK(stats.fragmentsStored == stats.fragmentsRequested && stats.fragmentsStored > inserts.size());
+            CHECK(stats.maxDepthComplexity >= 12);
+
+            // Resolving consumed the lists: a second resolve changes nothing
+            oit.resolve(framebuffer, pool);
+            CHECK(samePixels(framebuffer, expected));
+        }
+
+        CHECK(!oit.insert(-1, 0, 0.0f, 0x80FFFFFF) && !oit.insert(WIDTH, 0, 0.0f, 0x80FFFFFF));
+    }
+
+    // Ten fragments on a pixel with a cap of four
+    void checkOverflowPolicies() {
+        const float depths[10] = { 5.0f, 1.0f, 9.0f, 3.0f, 7.0f, 0.5f, 8.0f, 2.0f, 6.0f, 4.0f };
+        Random random{ 3 };
+        uint32_t colors[10];
+        for (uint32_t& c : colors) c = random.translucent();
+
+        OITConfig config;
+        config.initialFragments = 256;
+        config.maxFragmentsPerPixel = 4;
+
+        // KeepNearest stores everything and composites the four nearest,
+        // whatever the insertion order
+        config.overflow = OITOverflow::KeepNearest;
+        Framebuffer forward = background(), backward = background();
+        for (int pass = 0; pass < 2; pass++) {
+            OITBuffer oit(WIDTH, HEIGHT, config);
+            oit.reset();
+            for (int i = 0; i < 10; i++) {
+                const int k = pass == 0 ? i : 9 - i;
+                CHECK(oit.insert(4, 5, depths[k], colors[k]));
+            }
+            oit.resolve(pass == 0 ? forward : backward);
+            const OITStats stats = oit.getStats();
+            CHECK(stats.fragmentsStored == 10 && stats.fragmentsDropped == 0);
+            CHECK(stats.fragmentsDiscarded == 6 && stats.maxDepthComplexity == 10);
+        }
+        Reference nearest;
+        for (int i = 0; i < 10; i++) nearest.add(4, 5, depths[i], colors[i]);
+        CHECK(samePixels(forward, nearest.resolve(4)));
+        CHECK(samePixels(backward, forward));
+
+        // DropNewest keeps the first four to arrive and refuses the rest
+        config.overflow = OITOverflow::DropNewest;
+        OITBuffer oit(WIDTH, HEIGHT, config);
+        oit.reset();
+        Reference firstFour;
+        for (int i = 0; i < 10; i++) {
+            CHECK(oit.insert(4, 5, depths[i], colors[i]) == (i < 4));
+            if (i < 4) firstFour.add(4, 5, depths[i], colors[i]);
+        }
+        CHECK(oit.insert(5, 5, 1.0f, colors[0]));   // Other pixels are unaffected
+        firstFour.add(5, 5, 1.0f, colors[0]);
+        Framebuffer dropped = background();
+        oit.resolve(dropped);
+        CHECK(samePixels(dropped, firstFour.resolve(4)));
+        const OITStats stats = oit.getStats();
+        CHECK(stats.fragmentsStored == 5 && stats.fragmentsDropped == 6);
+        CHECK(stats.fragmentsRequested == 11 && stats.fragmentsDiscarded == 0);
+    }
+
+    // A frame that overflows the pool drops fragments; the next reset()
+    // grows the pool to that demand (plus headroom), never past maxFragments
+    void checkPoolGrowth() {
+        OITConfig config;
+        config.initialFragments = 64;
+        config.maxFragments = 1000;
+        OITBuffer oit(WIDTH, HEIGHT, config);
+        CHECK(oit.getStats().poolCapacity == 64);
+
+        Random random{ 11 };
+        std::vector<Sample> frame(200);
+        for (Sample& s : frame) s = { float(random.below(1000)), random.translucent() };
+        auto insertFrame = [&](size_t count) {
+            Reference reference;
+            for (size_t i = 0; i < count; i++) {
+                const int x = int(i % WIDTH), y = int(i / WIDTH) % HEIGHT;
+                if (oit.insert(x, y, frame[i % frame.size()].depth, frame[i % frame.size()].color)) {
+                    reference.add(x, y, frame[i % frame.size()].depth, frame[i % frame.size()].color);
+                }
+            }
+            return reference;
+        };
+
+        oit.reset();
+        Reference kept = insertFrame(200);
+        OITStats stats = oit.getStats();
+        CHECK(stats.fragmentsStored == 64 && stats.fragmentsDropped == 136 && stats.fragmentsRequested == 200);
+        Framebuffer partial = background();
+        oit.resolve(partial);
+        CHECK(samePixels(partial, kept.resolve(16)));
+
+        oit.reset();
+        CHECK(oit.getStats().poolCapacity == 200 + 200 / 8);
+        Reference all = insertFrame(200);
+        stats = oit.getStats();
+        CHECK(stats.fragmentsStored == 200 && stats.fragmentsDropped == 0);
+        Framebuffer complete = background();
+        oit.resolve(complete);
+        CHECK(samePixels(complete, all.resolve(16)));
+
+        // Demand past the cap grows only to maxFragments
+        oit.reset();
+        insertFrame(3000);
+        CHECK(oit.getStats().fragmentsRequested == 3000);
+        oit.reset();
+        CHECK(oit.getStats().poolCapacity == 1000);
+
+        // A frame that is reset without being resolved leaves nothing behind
+        insertFrame(50);
+        oit.reset();
+        Framebuffer untouched = background();
+        oit.resolve(untouched);
+        CHECK(samePixels(untouched, background()));
+    }
+}
+
+int main() {
+    checkAgainstReference(nullptr);
+    ThreadPool pool(4);
+    checkAgainstReference(&pool);
+    checkOverflowPolicies();
+    checkPoolGrowth();
+    return TestFailures();
+}
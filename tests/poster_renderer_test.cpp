@@ -0,0 +1,166 @@
+#include "offline/poster_renderer.h"
+#include "core/thread_pool.h"
+#include "image/tga_export.h"
+#include "math/vec4.h"
+#include "rendering/command_buffer.h"
+#include "test_util.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr int WIDTH = 203;
+    constexpr int HEIGHT = 157;
+
+    // A fan of shaded triangles at different depths, projected straight to
+    // target pixels with whatever projection the target gets
+    void renderScene(Framebuffer& target, const mat4& projection) {
+        CommandBuffer commands;
+        commands.clear(0xFF101018);
+        const mat4 view = mat4::lookAt(vec3(0.5f, 3.0f, 9.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+        const mat4 viewProjection = projection * view;
+        for (int i = 0; i < 24; i++) {
+            const float angle = 0.2618f * i;
+            const float radius = 1.0f + 0.15f * i;
+            const vec3 corners[3] = {
+                vec3(std::cos(angle) * radius, 0.3f * (i % 5), std::sin(angle) * radius),
+                vec3(std::cos(angle + 0.9f) * radius * 1.3f, -0.7f, std::sin(angle + 0.9f) * radius * 1.3f),
+                vec3(0.2f * i - 2.0f, 1.5f + 0.1f * i, -1.0f),
+            };
+            float x[3], y[3];
+            for (int c = 0; c < 3; c++) {
+                const vec4 clip = viewProjection * vec4(corners[c], 1.0f);
+                x[c] = (clip.x / clip.w + 1.0f) * 0.5f * target.getWidth();
+                y[c] = (1.0f - clip.y / clip.w) * 0.5f * target.getHeight();
+            }
+            commands.setDepth(float(24 - i));
+            commands.fillTriangle(x[0], y[0], x[1], y[1], x[2], y[2],
+                                  color(0.2f + 0.03f * i, 0.5f, 0.9f - 0.03f * i, 1.0f), color::white(), color::blue());
+        }
+        commands.execute(target);
+    }
+
+    mat4 sceneProjection() {
+        return mat4::perspective(0.9f, float(WIDTH) / HEIGHT, 0.5f, 50.0f);
+    }
+
+    std::vector<std::string> readLines(const std::string& path) {
+        std::vector<std::string> lines;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    // Tiles that don't divide the poster: the stitched tiles equal one
+    // full-size render, and the manifest places each of them correctly
+    void checkStitching(int tileWidth, int tileHeight, ThreadPool* pool) {
+        PosterConfig config;
+        config.width = WIDTH;
+        config.height = HEIGHT;
+        config.tileWidth = tileWidth;
+        config.tileHeight = tileHeight;
+        config.outputPrefix = "poster_renderer_test";
+        config.rle = (tileWidth % 2) == 0;
+
+        PosterRenderer poster(config);
+        const int columns = (WIDTH + tileWidth - 1) / tileWidth;
+        const int rows = (HEIGHT + tileHeight - 1) / tileHeight;
+        CHECK(poster.getColumns() == columns && poster.getRows() == rows);
+
+        std::vector<int> seen(size_t(columns) * rows, 0);
+        bool regionsOk = true;
+        CHECK(poster.render(sceneProjection(), [&](Framebuffer& tile, const mat4& projection, const RasterRect& region) {
+            regionsOk = regionsOk && tile.getWidth() == region.maxX - region.minX &&
+                        tile.getHeight() == region.maxY - region.minY;
+            seen[size_t(region.minY / tileHeight) * columns + region.minX / tileWidth]++;
+            renderScene(tile, projection);
+        }, pool));
+        CHECK(regionsOk);
+        for (int count : seen) CHECK(count == 1);
+        CHECK(poster.getStats().tilesWritten == columns * rows);
+        CHECK(poster.getStats().bandsCompleted == rows);
+        CHECK(poster.getStats().bytesWritten > 0);
+
+        Framebuffer full(WIDTH, HEIGHT);
+        renderScene(full, sceneProjection());
+        const TGAImage reference = FramebufferToTGA(full);
+
+        // Manifest: header, one line per tile in band order, then "complete"
+        const std::vector<std::string> lines = readLines(poster.manifestFilename());
+        CHECK(lines.size() == size_t(2 + columns * rows + 1));
+        if (lines.size() != size_t(2 + columns * rows + 1)) return;
+        CHECK(lines[0] == "poster " + std::to_string(WIDTH) + " " + std::to_string(HEIGHT));
+        CHECK(lines[1] == "tiles " + std::to_string(tileWidth) + " " + std::to_string(tileHeight) + " " +
+                          std::to_string(columns) + " " + std::to_string(rows));
+        CHECK(lines.back() == "complete");
+
+        int mismatches = 0;
+        long coveredPixels = 0;
+        for (size_t i = 2; i + 1 < lines.size(); i++) {
+            std::istringstream fields(lines[i]);
+            std::string keyword, filename;
+            int row, column, x, y, w, h;
+            fields >> keyword >> row >> column >> x >> y >> w >> h >> filename;
+            const int index = static_cast<int>(i - 2);
+            CHECK(keyword == "tile" && row == index / columns && column == index % columns);
+            CHECK(x == column * tileWidth && y == row * tileHeight);
+            CHECK(w == std::min(tileWidth, WIDTH - x) && h == std::min(tileHeight, HEIGHT - y));
+            CHECK(filename == poster.tileFilename(row, column));
+            coveredPixels += long(w) * h;
+
+            TGAImage tile;
+            CHECK(tile.read_tga_file(filename));
+            CHECK(tile.width() == w && tile.height() == h);
+            if (tile.width() != w || tile.height() != h) continue;
+            for (int ty = 0; ty < h; ty++) {
+                for (int tx = 0; tx < w; tx++) {
+                    const TGAColor a = tile.get(tx, ty), b = reference.get(x + tx, y + ty);
+                    if (a.bgra[0] != b.bgra[0] || a.bgra[1] != b.bgra[1] || a.bgra[2] != b.bgra[2] ||
+                        a.bgra[3] != b.bgra[3]) {
+                        mismatches++;
+                    }
+                }
+            }
+            std::remove(filename.c_str());
+        }
+        CHECK(coveredPixels == long(WIDTH) * HEIGHT);
+        CHECK(mismatches == 0);
+        std::remove(poster.manifestFilename().c_str());
+    }
+
+    // SubProjection of the whole image is the projection itself, and a
+    // region's corners land on NDC +-1
+    void checkSubProjection() {
+        const mat4 projection = sceneProjection();
+        const mat4 whole = SubProjection(projection, WIDTH, HEIGHT, { 0, 0, WIDTH, HEIGHT });
+        for (int i = 0; i < 16; i++) {
+            CHECK(std::fabs(whole.data()[i] - projection.data()[i]) <= 1e-6f * (1.0f + std::fabs(projection.data()[i])));
+        }
+
+        const RasterRect region = { 50, 40, 90, 100 };
+        const mat4 sub = SubProjection(projection, WIDTH, HEIGHT, region);
+        const vec3 point(0.3f, -0.2f, -4.0f);
+        const vec3 fullNdc = projection * point;
+        const vec3 subNdc = sub * point;
+        const float fullX = (fullNdc.x + 1.0f) * 0.5f * WIDTH, fullY = (1.0f - fullNdc.y) * 0.5f * HEIGHT;
+        const float subX = (subNdc.x + 1.0f) * 0.5f * 40, subY = (1.0f - subNdc.y) * 0.5f * 60;
+        CHECK(std::fabs(subX - (fullX - region.minX)) < 1e-3f);
+        CHECK(std::fabs(subY - (fullY - region.minY)) < 1e-3f);
+        CHECK(std::fabs(subNdc.z - fullNdc.z) < 1e-6f);
+    }
+}
+
+int main() {
+    checkSubProjection();
+    checkStitching(64, 48, nullptr);
+    checkStitching(37, 23, nullptr);
+    ThreadPool pool(3);
+    checkStitching(50, 157, &pool);
+    checkStitching(256, 40, &pool);
+    return TestFailures();
+}
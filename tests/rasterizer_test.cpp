@@ -0,0 +1,209 @@
+#include "rendering/rasterizer.h"
+#include "test_util.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+    constexpr int SIZE = 64;
+
+    struct Point {
+        float x, y;
+    };
+
+    // Per-pixel fragment counts over a SIZE x SIZE target
+    struct Coverage {
+        std::vector<int> counts = std::vector<int>(SIZE * SIZE, 0);
+        bool weightsOk = true;
+
+        void add(const Point& a, const Point& b, const Point& c, const RasterRect& clip = { 0, 0, SIZE, SIZE }) {
+            RasterizeTriangle(a.x, a.y, b.x, b.y, c.x, c.y, clip, [&](int x, int y, float l0, float l1, float l2) {
+                counts[y * SIZE + x]++;
+                if (std::fabs(l0 + l1 + l2 - 1.0f) > 1e-4f || l0 < -1e-6f || l1 < -1e-6f || l2 < -1e-6f) {
+                    weightsOk = false;
+                }
+            });
+        }
+
+        int at(int x, int y) const { return counts[y * SIZE + x]; }
+
+        int total() const {
+            int sum = 0;
+            for (int count : counts) sum += count;
+            return sum;
+        }
+
+        int maxCount() const {
+            int most = 0;
+            for (int count : counts) most = count > most ? count : most;
+            return most;
+        }
+    };
+
+    // A fan around an interior vertex and a quad cut along either diagonal
+    // cover every pixel inside exactly once: no cracks, no double hits
+    void checkWatertight() {
+        // Fan: center on a pixel center, rim vertices at arbitrary sub-pixel spots
+        Coverage fan;
+        const Point center = { 32.5f, 32.5f };
+        constexpr int SEGMENTS = 13;
+        const float radius = 25.3f;
+        for (int i = 0; i < SEGMENTS; i++) {
+            const float a0 = 6.2831853f * i / SEGMENTS + 0.1f;
+            const float a1 = 6.2831853f * (i + 1) / SEGMENTS + 0.1f;
+            const Point p0 = { center.x + radius * std::cos(a0), center.y + radius * std::sin(a0) };
+            const Point p1 = { center.x + radius * std::cos(a1), center.y + radius * std::sin(a1) };
+            // Alternate the winding: coverage must not depend on it
+            if (i % 2) {
+                fan.add(center, p0, p1);
+            } else {
+                fan.add(center, p1, p0);
+            }
+        }
+        CHECK(fan.maxCount() == 1);
+        CHECK(fan.weightsOk);
+        const float inner = radius * std::cos(3.14159265f / SEGMENTS) - 1.0f;
+        for (int y = 0; y < SIZE; y++) {
+            for (int x = 0; x < SIZE; x++) {
+                const float dx = x + 0.5f - center.x, dy = y + 0.5f - center.y;
+                if (dx * dx + dy * dy < inner * inner) {
+                    CHECK(fan.at(x, y) == 1);
+                }
+            }
+        }
+
+        // Quad split along both diagonals: same pixels, each once
+        const Point q[4] = { { 4.25f, 3.5f }, { 40.75f, 6.0f }, { 44.5f, 38.125f }, { 2.0f, 36.0f } };
+        Coverage first, second;
+        first.add(q[0], q[1], q[2]);
+        first.add(q[0], q[2], q[3]);
+        second.add(q[0], q[1], q[3]);
+        second.add(q[1], q[2], q[3]);
+        CHECK(first.maxCount() == 1 && second.maxCount() == 1);
+        CHECK(first.counts == second.counts);
+        CHECK(first.total() > 1000);
+
+        // Two quads sharing an edge that runs through pixel centers
+        Coverage halves;
+        halves.add({ 0.5f, 0.5f }, { 16.5f, 0.5f }, { 16.5f, 20.5f });
+        halves.add({ 0.5f, 0.5f }, { 16.5f, 20.5f }, { 0.5f, 20.5f });
+        halves.add({ 16.5f, 0.5f }, { 30.5f, 0.5f }, { 30.5f, 20.5f });
+        halves.add({ 16.5f, 0.5f }, { 30.5f, 20.5f }, { 16.5f, 20.5f });
+        CHECK(halves.maxCount() == 1);
+        CHECK(halves.total() == 30 * 20);
+    }
+
+    // Pixel centers exactly on an edge belong to the triangle only if the
+    // edge is a top or left edge
+    void checkTopLeft() {
+        // Axis-aligned square with all four edges through pixel centers:
+        // left and top columns are in, right and bottom are out
+        Coverage square;
+        square.add({ 2.5f, 3.5f }, { 6.5f, 3.5f }, { 6.5f, 7.5f });
+        square.add({ 2.5f, 3.5f }, { 6.5f, 7.5f }, { 2.5f, 7.5f });
+        CHECK(square.total() == 16);
+        CHECK(square.maxCount() == 1);
+        for (int y = 3; y < 7; y++) {
+            for (int x = 2; x < 6; x++) {
+                CHECK(square.at(x, y) == 1);
+            }
+        }
+        CHECK(square.at(6, 3) == 0 && square.at(2, 7) == 0 && square.at(1, 4) == 0 && square.at(3, 2) == 0);
+
+        // Single triangles: a top edge owns its centers, a bottom edge doesn't
+        Coverage top, bottom;
+        top.add({ 10.5f, 10.5f }, { 14.5f, 10.5f }, { 12.5f, 12.5f });
+        bottom.add({ 10.5f, 12.5f }, { 12.5f, 10.5f }, { 14.5f, 12.5f });
+        CHECK(top.at(11, 10) == 1 && top.at(12, 10) == 1 && top.at(13, 10) == 1);
+        CHECK(bottom.at(11, 12) == 0 && bottom.at(12, 12) == 0 && bottom.at(13, 12) == 0);
+        CHECK(top.at(14, 10) == 0);   // Right end of the top edge is on the right edge too
+
+        // A diagonal through centers is owned by exactly one side
+        Coverage diagonal;
+        diagonal.add({ 20.5f, 20.5f }, { 28.5f, 20.5f }, { 28.5f, 28.5f });
+        diagonal.add({ 20.5f, 20.5f }, { 28.5f, 28.5f }, { 20.5f, 28.5f });
+        for (int i = 0; i < 8; i++) {
+            CHECK(diagonal.at(20 + i, 20 + i) == 1);
+        }
+        CHECK(diagonal.maxCount() == 1);
+
+        // Vertex-only contact: a triangle touching a center with just one
+        // vertex and its bottom/right edges covers nothing there
+        Coverage sliver;
+        sliver.add({ 40.5f, 40.5f }, { 40.0f, 40.0f }, { 41.0f, 40.0f });
+        CHECK(sliver.at(40, 40) == 0);
+    }
+
+    // Sub-pixel positions snap to 1/16 pixel, whole-pixel moves shift the
+    // coverage exactly, and the guard band / clip rectangle are honoured
+    void checkSubPixelAndGuardBand() {
+        // On the 1/16 grid, so the nudges below stay within one snapping step
+        const Point a = { 5.3125f, 4.875f }, b = { 27.125f, 9.6875f }, c = { 11.625f, 29.4375f };
+        Coverage base;
+        base.add(a, b, c);
+
+        // Offsets below half a subpixel snap to the same fixed-point vertices
+        Coverage nudged;
+        nudged.add({ a.x + 0.02f, a.y - 0.02f }, { b.x + 0.02f, b.y + 0.01f }, { c.x - 0.01f, c.y + 0.02f });
+        CHECK(nudged.counts == base.counts);
+
+        // Moving by whole pixels moves the coverage with it
+        Coverage moved;
+        moved.add({ a.x + 9.0f, a.y + 17.0f }, { b.x + 9.0f, b.y + 17.0f }, { c.x + 9.0f, c.y + 17.0f });
+        CHECK(moved.total() == base.total());
+        for (int y = 0; y + 17 < SIZE; y++) {
+            for (int x = 0; x + 9 < SIZE; x++) {
+                CHECK(moved.at(x + 9, y + 17) == base.at(x, y));
+            }
+        }
+
+        // Sub-pixel steps sweep the edge across the centers one at a time
+        int previous = 0;
+        for (int step = 0; step <= 16; step++) {
+            Coverage shifted;
+            const float dx = step / 16.0f;
+            shifted.add({ 0.0f + dx, 0.0f }, { 8.0f + dx, 0.0f }, { 8.0f + dx, 8.0f });
+            shifted.add({ 0.0f + dx, 0.0f }, { 8.0f + dx, 8.0f }, { 0.0f + dx, 8.0f });
+            CHECK(shifted.total() == 64);
+            CHECK(shifted.maxCount() == 1);
+            const int firstColumn = shifted.at(0, 0) ? 0 : 1;
+            if (step > 0) CHECK(firstColumn >= previous);
+            previous = firstColumn;
+        }
+        CHECK(previous == 1);
+
+        // Clipping matches the unclipped result inside the clip rectangle
+        Coverage clipped;
+        const RasterRect clip = { 8, 6, 20, 25 };
+        clipped.add(a, b, c, clip);
+        for (int y = 0; y < SIZE; y++) {
+            for (int x = 0; x < SIZE; x++) {
+                const bool inside = x >= clip.minX && x < clip.maxX && y >= clip.minY && y < clip.maxY;
+                CHECK(clipped.at(x, y) == (inside ? base.at(x, y) : 0));
+            }
+        }
+
+        // Vertices far outside the target but inside the guard band: the
+        // edge functions stay exact and the visible part is covered once
+        const float far = RASTER_GUARD_BAND * 0.9f;
+        Coverage huge;
+        huge.add({ -far, -far }, { far, -far }, { far, far });
+        huge.add({ -far, -far }, { far, far }, { -far, far });
+        CHECK(huge.total() == SIZE * SIZE);
+        CHECK(huge.maxCount() == 1);
+
+        // Beyond the guard band, or NaN: rejected, never garbage
+        TriangleSetup setup;
+        const RasterRect everything = { 0, 0, SIZE, SIZE };
+        CHECK(!SetupTriangle(-2.0f * RASTER_GUARD_BAND, 0.0f, 10.0f, 0.0f, 10.0f, 10.0f, everything, setup));
+        CHECK(!SetupTriangle(std::nanf(""), 0.0f, 10.0f, 0.0f, 10.0f, 10.0f, everything, setup));
+        CHECK(!SetupTriangle(1.0f, 1.0f, 5.0f, 5.0f, 9.0f, 9.0f, everything, setup));   // Degenerate
+        CHECK(!SetupTriangle(100.0f, 100.0f, 110.0f, 100.0f, 110.0f, 110.0f, everything, setup));  // Off target
+    }
+}
+
+int main() {
+    checkWatertight();
+    checkTopLeft();
+    checkSubPixelAndGuardBand();
+    return TestFailures();
+}
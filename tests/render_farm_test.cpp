@@ -0,0 +1,145 @@
+#include "offline/render_farm.h"
+#include "test_util.h"
+#include <atomic>
+#include <csignal>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    constexpr int WIDTH = 40;
+    constexpr int HEIGHT = 24;
+    constexpr int TILE = 16;
+
+    uint32_t expectedPixel(int x, int y, int frameIndex) {
+        return 0xFF000000u | uint32_t(frameIndex) << 16 | uint32_t(y) << 8 | uint32_t(x);
+    }
+
+    void paintTile(Framebuffer& frame, const RasterRect& tile, int frameIndex) {
+        for (int y = tile.minY; y < tile.maxY; y++) {
+            for (int x = tile.minX; x < tile.maxX; x++) {
+                frame.setPixel(x, y, expectedPixel(x, y, frameIndex));
+            }
+        }
+    }
+
+    bool frameMatches(const Framebuffer& frame, int frameIndex) {
+        for (int y = 0; y < HEIGHT; y++) {
+            for (int x = 0; x < WIDTH; x++) {
+                if (frame.getPixel(x, y) != expectedPixel(x, y, frameIndex)) return false;
+            }
+        }
+        return true;
+    }
+
+    // Counters shared with the forked workers: created before the farm forks
+    struct SharedCounters {
+        std::atomic<int> attempts[4];
+    };
+
+    SharedCounters* mapCounters() {
+        void* memory = mmap(nullptr, sizeof(SharedCounters), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) return nullptr;
+        SharedCounters* counters = static_cast<SharedCounters*>(memory);
+        for (std::atomic<int>& attempt : counters->attempts) {
+            new (&attempt) std::atomic<int>(0);
+        }
+        return counters;
+    }
+
+    RenderFarmConfig smallConfig(int workers, int maxRestarts) {
+        RenderFarmConfig config;
+        config.width = WIDTH;
+        config.height = HEIGHT;
+        config.tileSize = TILE;   // Doesn't divide the frame: 3 x 2 tiles with ragged edges
+        config.workerCount = workers;
+        config.framesPerBatch = 2;
+        config.maxRestarts = maxRestarts;
+        return config;
+    }
+
+    // Workers that die mid-tile - by signal, by non-zero exit and by an
+    // escaping exception - have their tiles requeued and are replaced
+    void checkCrashRequeue(SharedCounters* counters) {
+        RenderFarm farm(smallConfig(2, 8));
+        std::vector<int> delivered;
+        bool pixelsOk = true;
+        const bool ok = farm.renderSequence(0, 3, [counters](Framebuffer& frame, const RasterRect& tile, int frameIndex) {
+            // Scribble first: the retry has to overwrite a half-finished tile
+            frame.setPixel(tile.minX, tile.minY, 0xDEADBEEF);
+            if (frameIndex == 0 && tile.minX == TILE && tile.minY == 0 && counters->attempts[0]++ == 0) {
+                kill(getpid(), SIGKILL);
+            }
+            if (frameIndex == 1 && tile.maxX == WIDTH && tile.maxY == HEIGHT && counters->attempts[1]++ == 0) {
+                _exit(3);
+            }
+            if (frameIndex == 2 && tile.minX == 0 && tile.minY == TILE && counters->attempts[2]++ == 0) {
+                throw std::runtime_error("simulated tile failure");
+            }
+            paintTile(frame, tile, frameIndex);
+        }, [&](const Framebuffer& frame, int frameIndex) {
+            delivered.push_back(frameIndex);
+            pixelsOk = pixelsOk && frameMatches(frame, frameIndex);
+            return true;
+        });
+
+        CHECK(ok);
+        CHECK(pixelsOk);
+        CHECK((delivered == std::vector<int>{ 0, 1, 2 }));
+        CHECK(counters->attempts[0] == 2 && counters->attempts[1] == 2 && counters->attempts[2] == 2);
+        const RenderFarmStats& stats = farm.getStats();
+        CHECK(stats.workerCrashes == 3);
+        CHECK(stats.workerRestarts == 3);
+        CHECK(stats.framesCompleted == 3);
+        CHECK(stats.tilesRendered == 3 * 6);
+    }
+
+    // A tile that kills every worker exhausts the restart budget: the batch
+    // fails and no frame is delivered
+    void checkRestartLimit(SharedCounters* counters) {
+        RenderFarm farm(smallConfig(1, 2));
+        int delivered = 0;
+        const bool ok = farm.renderSequence(5, 1, [counters](Framebuffer& frame, const RasterRect& tile, int frameIndex) {
+            if (tile.minX == 0 && tile.minY == 0) {
+                counters->attempts[3]++;
+                _exit(1);
+            }
+            paintTile(frame, tile, frameIndex);
+        }, [&](const Framebuffer&, int) {
+            delivered++;
+            return true;
+        });
+
+        CHECK(!ok);
+        CHECK(delivered == 0);
+        CHECK(counters->attempts[3] == 3);   // First worker plus two replacements
+        const RenderFarmStats& stats = farm.getStats();
+        CHECK(stats.workerCrashes == 3);
+        CHECK(stats.workerRestarts == 2);
+        CHECK(stats.framesCompleted == 0);
+    }
+
+    // No crashes: renderFrame copies the finished frame out
+    void checkRenderFrame() {
+        RenderFarm farm(smallConfig(3, 0));
+        Framebuffer out(1, 1);
+        CHECK(farm.renderFrame(7, paintTile, out));
+        CHECK(out.getWidth() == WIDTH && out.getHeight() == HEIGHT);
+        CHECK(frameMatches(out, 7));
+        CHECK(farm.getStats().workerCrashes == 0);
+    }
+}
+
+int main() {
+    SharedCounters* counters = mapCounters();
+    CHECK(counters != nullptr);
+    if (counters) {
+        checkCrashRequeue(counters);
+        checkRestartLimit(counters);
+        munmap(counters, sizeof(SharedCounters));
+    }
+    checkRenderFrame();
+    return TestFailures();
+}
@@ -0,0 +1,133 @@
+#include "scene/scene_graph.h"
+#include "test_util.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+    bool nearIdentity(const mat4& m, float epsilon = 1e-5f) {
+        for (int col = 0; col < 4; col++) {
+            for (int row = 0; row < 4; row++) {
+                if (std::fabs(m.m[col][row] - (col == row ? 1.0f : 0.0f)) > epsilon) return false;
+            }
+        }
+        return true;
+    }
+
+    bool near(const vec3& a, const vec3& b, float epsilon = 1e-5f) {
+        return std::fabs(a.x - b.x) <= epsilon && std::fabs(a.y - b.y) <= epsilon && std::fabs(a.z - b.z) <= epsilon;
+    }
+
+    void checkInverses() {
+        const mat4 affine = mat4::translate(3.0f, -2.0f, 5.0f) * mat4::rotate(0.7f, vec3(1.0f, 2.0f, 3.0f).normalized()) *
+                            mat4::scale(2.0f, 0.5f, 4.0f);
+        const mat4 projection = mat4::perspective(0.8f, 1.5f, 0.5f, 100.0f) * affine;
+
+        CHECK(mat4().isAffine());
+        CHECK(affine.isAffine());
+        CHECK(!projection.isAffine());
+
+        CHECK(nearIdentity(affine * affine.inverseAffine()));
+        CHECK(nearIdentity(affine.inverseAffine() * affine));
+        CHECK(nearIdentity(affine * affine.inverse()));
+        CHECK(nearIdentity(projection * projection.inverse(), 1e-4f));
+        CHECK(nearIdentity(projection.inverse() * projection, 1e-4f));
+        CHECK(nearIdentity(mat4().inverse()));
+
+        // Singular input gives identity rather than garbage
+        CHECK(nearIdentity(mat4::scale(1.0f, 0.0f, 1.0f).inverseAffine()));
+        CHECK(nearIdentity(mat4::scale(1.0f, 0.0f, 1.0f).inverseTranspose()));
+
+        // inverseTranspose: transposed, it undoes the upper 3x3 and carries
+        // no translation. Normals stay perpendicular to transformed tangents.
+        const mat4 normalMatrix = affine.inverseTranspose();
+        mat4 product = normalMatrix.transposed() * affine;
+        product.m[3][0] = product.m[3][1] = product.m[3][2] = 0.0f;
+        CHECK(nearIdentity(product));
+        CHECK(normalMatrix.m[3][0] == 0.0f && normalMatrix.m[3][1] == 0.0f && normalMatrix.m[3][2] == 0.0f);
+        const vec3 normal(0.0f, 1.0f, 0.0f);
+        const vec3 tangent(1.0f, 0.0f, 1.0f);
+        CHECK(std::fabs(normalMatrix.transformDirection(normal).dot(affine.transformDirection(tangent))) < 1e-5f);
+    }
+
+    // Moving a mid-tree node updates exactly its subtree
+    void checkDirtyPropagation() {
+        SceneGraph graph;
+        const NodeId root = graph.createNode(INVALID_NODE, mat4::translate(1.0f, 0.0f, 0.0f));
+        const NodeId otherRoot = graph.createNode(INVALID_NODE, mat4::translate(0.0f, 0.0f, 7.0f));
+        const NodeId mid = graph.createNode(root, mat4::translate(0.0f, 1.0f, 0.0f));
+        const NodeId leaf = graph.createNode(mid, mat4::translate(0.0f, 0.0f, 1.0f));
+        const NodeId sibling = graph.createNode(root, mat4::translate(0.0f, -1.0f, 0.0f));
+        const NodeId otherLeaf = graph.createNode(mid, mat4::scale(2.0f));
+        const NodeId grandchild = graph.createNode(leaf, mat4::translate(1.0f, 0.0f, 0.0f));
+
+        SceneGraph::UpdateStats stats = graph.updateWorldTransforms();
+        CHECK(stats.nodesUpdated == 7 && stats.nodesScanned == 7);
+        const vec3 origin(0.0f, 0.0f, 0.0f);
+        CHECK(near(graph.getWorldTransform(grandchild) * origin, vec3(2.0f, 1.0f, 1.0f)));
+
+        // Nothing dirty: nothing scanned
+        stats = graph.updateWorldTransforms();
+        CHECK(stats.nodesUpdated == 0 && stats.nodesScanned == 0);
+        CHECK(graph.getUpdatedNodes().empty());
+
+        const mat4 rootWorld = graph.getWorldTransform(root);
+        const mat4 siblingWorld = graph.getWorldTransform(sibling);
+        const mat4 otherWorld = graph.getWorldTransform(otherRoot);
+
+        graph.setLocalTransform(mid, mat4::translate(0.0f, 5.0f, 0.0f));
+        stats = graph.updateWorldTransforms();
+        CHECK(graph.getUpdatedNodes() == std::vector<NodeId>({ mid, leaf, otherLeaf, grandchild }));
+        CHECK(stats.nodesUpdated == 4);
+        CHECK(stats.nodesScanned == graph.getNodeCount() - mid);
+        CHECK(graph.getLastUpdateStats().nodesUpdated == 4);
+
+        CHECK(near(graph.getWorldTransform(mid) * origin, vec3(1.0f, 5.0f, 0.0f)));
+        CHECK(near(graph.getWorldTransform(leaf) * origin, vec3(1.0f, 5.0f, 1.0f)));
+        CHECK(near(graph.getWorldTransform(grandchild) * origin, vec3(2.0f, 5.0f, 1.0f)));
+        CHECK(near(graph.getWorldTransform(otherLeaf) * vec3(1.0f, 0.0f, 0.0f), vec3(3.0f, 5.0f, 0.0f)));
+
+        // Untouched nodes keep their matrices bit for bit
+        CHECK(std::memcmp(&rootWorld, &graph.getWorldTransform(root), sizeof(mat4)) == 0);
+        CHECK(std::memcmp(&siblingWorld, &graph.getWorldTransform(sibling), sizeof(mat4)) == 0);
+        CHECK(std::memcmp(&otherWorld, &graph.getWorldTransform(otherRoot), sizeof(mat4)) == 0);
+
+        // Moving a leaf touches only the leaf
+        graph.setLocalTransform(grandchild, mat4::translate(0.0f, 0.0f, 2.0f));
+        stats = graph.updateWorldTransforms();
+        CHECK(graph.getUpdatedNodes() == std::vector<NodeId>({ grandchild }));
+        CHECK(near(graph.getWorldTransform(grandchild) * origin, vec3(1.0f, 5.0f, 3.0f)));
+
+        // The normal matrix follows the world transform
+        CHECK(nearIdentity(graph.getNormalMatrix(otherLeaf).transposed() * mat4::scale(2.0f)));
+    }
+}
+
+int main() {
+    checkInverses();
+    checkDirtyPropagation();
+
+    SceneGraph graph;
+    const NodeId root = graph.createNode();
+    const NodeId child = graph.createNode(root, mat4::translate(1.0f, 0.0f, 0.0f));
+    CHECK(root == 0);
+    CHECK(child == 1);
+
+    // Parents that don't exist yet are rejected, not turned into roots
+    CHECK(graph.createNode(2) == INVALID_NODE);
+    CHECK(graph.createNode(100) == INVALID_NODE);
+    CHECK(graph.getNodeCount() == 2);
+
+    // Negative ids other than INVALID_NODE are rejected too
+    CHECK(graph.createNode(-2) == INVALID_NODE);
+    CHECK(graph.createNode(-1000) == INVALID_NODE);
+    CHECK(graph.getNodeCount() == 2);
+
+    // The graph is still consistent afterwards
+    const NodeId grandchild = graph.createNode(child, mat4::translate(0.0f, 2.0f, 0.0f));
+    CHECK(grandchild == 2);
+    graph.updateWorldTransforms();
+    const vec3 p = graph.getWorldTransform(grandchild) * vec3(0.0f, 0.0f, 0.0f);
+    CHECK(p.x == 1.0f && p.y == 2.0f && p.z == 0.0f);
+    return TestFailures();
+}
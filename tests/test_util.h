@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the test executables: each failed CHECK prints its
+// location and the test's main() returns TestFailures() as the exit code.
+inline int& TestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                          \
+    do {                                                                          \
+        if (!(condition)) {                                                       \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, \
+                         #condition);                                             \
+            TestFailures()++;                                                     \
+        }                                                                         \
+    } while (0)
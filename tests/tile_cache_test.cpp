@@ -0,0 +1,169 @@
+#include "rendering/tile_cache.h"
+#include "core/thread_pool.h"
+#include "test_util.h"
+#include <cstring>
+#include <set>
+
+namespace {
+    constexpr int WIDTH = 100;
+    constexpr int HEIGHT = 70;
+    constexpr int TILE = 16;              // Ragged last column and row
+    constexpr int TILES_X = 7;
+    constexpr int TILES_Y = 5;
+    constexpr uint32_t SENTINEL = 0x12345678;
+
+    struct Mover {
+        float x = 30.0f, y = 20.0f;
+        color tint = color::green();
+    };
+
+    // Static background and shapes plus one small triangle that tests move.
+    // The mover is recorded last so it is the buffer's last command.
+    void recordScene(CommandBuffer& commands, const Mover& mover) {
+        commands.reset();
+        commands.setLayer(0);
+        commands.clear(0xFF202020);
+        commands.setDepth(5.0f);
+        commands.fillTriangle(2.0f, 3.0f, 60.5f, 10.25f, 20.0f, 66.0f, color::blue());
+        commands.setDepth(3.0f);
+        commands.fillTriangle(55.0f, 5.0f, 97.0f, 40.0f, 60.0f, 68.0f, color::red(), color::green(), color::blue());
+        commands.drawLine(0, 69, 99, 0, color::white());
+        commands.drawTriangle(70, 50, 95, 52, 80, 66, color::yellow());
+        commands.setLayer(1);
+        commands.fillTriangle(10.0f, 40.0f, 90.0f, 45.0f, 40.0f, 60.0f, color(1.0f, 0.5f, 0.0f, 0.5f));
+        commands.setDepth(1.0f);
+        commands.fillTriangle(mover.x, mover.y, mover.x + 9.0f, mover.y + 2.0f, mover.x + 3.0f, mover.y + 8.0f,
+                              mover.tint);
+    }
+
+    std::set<int> tilesOf(const RasterRect& bounds) {
+        std::set<int> tiles;
+        for (int y = 0; y < HEIGHT; y++) {
+            for (int x = 0; x < WIDTH; x++) {
+                if (x >= bounds.minX && x < bounds.maxX && y >= bounds.minY && y < bounds.maxY) {
+                    tiles.insert((y / TILE) * TILES_X + x / TILE);
+                }
+            }
+        }
+        return tiles;
+    }
+
+    // Marks the first pixel of every tile; a tile that is redrawn loses it
+    void markTiles(Framebuffer& framebuffer) {
+        for (int ty = 0; ty < TILES_Y; ty++) {
+            for (int tx = 0; tx < TILES_X; tx++) {
+                framebuffer.setPixel(tx * TILE, ty * TILE, SENTINEL);
+            }
+        }
+    }
+
+    std::set<int> redrawnTiles(const Framebuffer& framebuffer) {
+        std::set<int> tiles;
+        for (int ty = 0; ty < TILES_Y; ty++) {
+            for (int tx = 0; tx < TILES_X; tx++) {
+                if (framebuffer.getPixel(tx * TILE, ty * TILE) != SENTINEL) {
+                    tiles.insert(ty * TILES_X + tx);
+                }
+            }
+        }
+        return tiles;
+    }
+
+    void render(TileCache& cache, const CommandBuffer& commands, Framebuffer& framebuffer, ThreadPool* pool = nullptr) {
+        RenderQueue queue;
+        queue.submit(commands);
+        cache.execute(queue, framebuffer, pool);
+    }
+
+    // A repeated frame is all hits; a changed command misses exactly the
+    // tiles it covered before or covers now
+    void checkHitsAndMisses() {
+        TileCache cache(TILE);
+        Framebuffer framebuffer(WIDTH, HEIGHT);
+        CommandBuffer commands;
+        Mover mover;
+        recordScene(commands, mover);
+
+        render(cache, commands, framebuffer);
+        CHECK(cache.getStats().tiles == TILES_X * TILES_Y);
+        CHECK(cache.getStats().misses == TILES_X * TILES_Y);
+        CHECK(cache.getStats().hits == 0);
+
+        // Same commands, re-recorded from scratch: nothing is redrawn
+        recordScene(commands, mover);
+        markTiles(framebuffer);
+        render(cache, commands, framebuffer);
+        CHECK(cache.getStats().hits == TILES_X * TILES_Y);
+        CHECK(cache.getStats().misses == 0 && cache.getStats().commandsExecuted == 0);
+        CHECK(redrawnTiles(framebuffer).empty());
+
+        // Move the small triangle across a tile boundary
+        const RasterRect before = commands.getCommands().back().bounds;
+        mover.x += 7.0f;
+        mover.y += 11.0f;
+        recordScene(commands, mover);
+        const RasterRect after = commands.getCommands().back().bounds;
+        std::set<int> expected = tilesOf(before);
+        for (int tile : tilesOf(after)) expected.insert(tile);
+        CHECK(expected.size() > 1 && expected.size() < 8);
+
+        markTiles(framebuffer);
+        render(cache, commands, framebuffer);
+        CHECK(cache.getStats().misses == static_cast<int>(expected.size()));
+        CHECK(cache.getStats().hits == TILES_X * TILES_Y - static_cast<int>(expected.size()));
+        CHECK(redrawnTiles(framebuffer) == expected);
+
+        // Recolor only: the tiles under the triangle, nothing else
+        mover.tint = color::magenta();
+        recordScene(commands, mover);
+        markTiles(framebuffer);
+        render(cache, commands, framebuffer);
+        CHECK(redrawnTiles(framebuffer) == tilesOf(after));
+
+        // invalidate() and a new framebuffer both redraw everything
+        cache.invalidate();
+        render(cache, commands, framebuffer);
+        CHECK(cache.getStats().misses == TILES_X * TILES_Y);
+        Framebuffer other(WIDTH, HEIGHT);
+        render(cache, commands, other);
+        CHECK(cache.getStats().misses == TILES_X * TILES_Y);
+        CHECK(std::memcmp(other.data(), framebuffer.data(), sizeof(uint32_t) * WIDTH * HEIGHT) == 0);
+    }
+
+    // Over an animation with static and moving frames, the cached target
+    // matches a full uncached replay after every frame
+    void checkMatchesUncached(ThreadPool* pool) {
+        TileCache cache(TILE);
+        Framebuffer cached(WIDTH, HEIGHT);
+        CommandBuffer commands;
+        Mover mover;
+        int totalHits = 0;
+        for (int frame = 0; frame < 12; frame++) {
+            if (frame % 3 != 2) {
+                mover.x = 5.0f + frame * 6.5f;
+                mover.y = 4.0f + (frame * 13) % 50 + 0.375f;
+            }
+            if (frame == 7) {
+                mover.tint = color(0.2f, 0.9f, 0.6f, 1.0f);
+            }
+            recordScene(commands, mover);
+            render(cache, commands, cached, pool);
+            totalHits += cache.getStats().hits;
+
+            Framebuffer reference(WIDTH, HEIGHT);
+            RenderQueue queue;
+            queue.submit(commands);
+            queue.execute(reference);
+            CHECK(std::memcmp(cached.data(), reference.data(), sizeof(uint32_t) * WIDTH * HEIGHT) == 0);
+        }
+        CHECK(totalHits > 11 * TILES_X * TILES_Y / 2);
+    }
+}
+
+int main() {
+    checkHitsAndMisses();
+    checkMatchesUncached(nullptr);
+    ThreadPool pool(3);
+    checkMatchesUncached(&pool);
+    return TestFailures();
+}
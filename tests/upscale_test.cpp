@@ -0,0 +1,143 @@
+#include "image/upscale.h"
+#include "core/thread_pool.h"
+#include "test_util.h"
+#include <cstring>
+
+namespace {
+    Framebuffer makeNoise(int width, int height, uint32_t seed) {
+        Framebuffer frame(width, height);
+        uint32_t state = seed;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                state = state * 1664525u + 1013904223u;
+                frame.setPixel(x, y, state);
+            }
+        }
+        return frame;
+    }
+
+    bool samePixels(const Framebuffer& a, const Framebuffer& b) {
+        return a.getWidth() == b.getWidth() && a.getHeight() == b.getHeight() &&
+               std::memcmp(a.data(), b.data(), sizeof(uint32_t) * a.getWidth() * a.getHeight()) == 0;
+    }
+
+    // 1:1 is an identity, also along one axis when only the other is scaled
+    void checkIdentity() {
+        const Framebuffer source = makeNoise(37, 23, 1);
+        Framebuffer same(37, 23);
+        UpscaleBilinear(source, same);
+        CHECK(samePixels(same, source));
+
+        // Same width: every column is only filtered vertically, so a source
+        // whose rows are all equal comes out with exactly those rows
+        Framebuffer columns(37, 23);
+        for (int y = 0; y < 23; y++) {
+            for (int x = 0; x < 37; x++) {
+                columns.setPixel(x, y, source.getPixel(x, 0));
+            }
+        }
+        Framebuffer taller(37, 61);
+        UpscaleBilinear(columns, taller);
+        for (int y = 0; y < 61; y++) {
+            for (int x = 0; x < 37; x++) {
+                CHECK(taller.getPixel(x, y) == source.getPixel(x, 0));
+            }
+        }
+
+        // Same height, rows constant along x
+        Framebuffer rows(5, 23);
+        for (int y = 0; y < 23; y++) {
+            for (int x = 0; x < 5; x++) {
+                rows.setPixel(x, y, source.getPixel(0, y));
+            }
+        }
+        Framebuffer wider(64, 23);
+        UpscaleBilinear(rows, wider);
+        for (int y = 0; y < 23; y++) {
+            for (int x = 0; x < 64; x++) {
+                CHECK(wider.getPixel(x, y) == source.getPixel(0, y));
+            }
+        }
+    }
+
+    // Positions past the outer pixel centers clamp: the border rows and
+    // columns of the output repeat the source's border exactly, and flat
+    // images stay flat right up to the edge
+    void checkEdgeClamp() {
+        Framebuffer source(2, 2);
+        source.setPixel(0, 0, 0xFF102030);
+        source.setPixel(1, 0, 0x80F0E0D0);
+        source.setPixel(0, 1, 0x40000000);
+        source.setPixel(1, 1, 0xFFFFFFFF);
+        Framebuffer destination(8, 8);
+        UpscaleBilinear(source, destination);
+        CHECK(destination.getPixel(0, 0) == source.getPixel(0, 0));
+        CHECK(destination.getPixel(7, 0) == source.getPixel(1, 0));
+        CHECK(destination.getPixel(0, 7) == source.getPixel(0, 1));
+        CHECK(destination.getPixel(7, 7) == source.getPixel(1, 1));
+        CHECK(destination.getPixel(1, 0) == source.getPixel(0, 0));   // Still left of the first center
+
+        Framebuffer flat(3, 5);
+        flat.clear(0x7F3366CC);
+        Framebuffer flatUp(17, 11);
+        UpscaleBilinear(flat, flatUp);
+        for (int y = 0; y < 11; y++) {
+            for (int x = 0; x < 17; x++) {
+                CHECK(flatUp.getPixel(x, y) == 0x7F3366CC);
+            }
+        }
+
+        // Interior weights: 2 -> 4 puts the middle samples at 1/4 and 3/4
+        Framebuffer ramp(2, 1);
+        ramp.setPixel(0, 0, 0xFF000000);
+        ramp.setPixel(1, 0, 0xFF0000FF);
+        Framebuffer rampUp(4, 1);
+        UpscaleBilinear(ramp, rampUp);
+        CHECK(rampUp.getPixel(0, 0) == 0xFF000000);
+        CHECK(rampUp.getPixel(1, 0) == 0xFF000040);
+        CHECK(rampUp.getPixel(2, 0) == 0xFF0000BF);
+        CHECK(rampUp.getPixel(3, 0) == 0xFF0000FF);
+
+        // Single-pixel source fills the whole output
+        Framebuffer one(1, 1);
+        one.clear(0x11223344);
+        Framebuffer oneUp(9, 3);
+        UpscaleBilinear(one, oneUp);
+        CHECK(oneUp.getPixel(0, 0) == 0x11223344 && oneUp.getPixel(8, 2) == 0x11223344);
+    }
+
+    // Strips over a pool and a reused scratch arena give the same pixels,
+    // and once the arena has grown a frame needs no extra memory
+    void checkPoolAndScratch() {
+        const Framebuffer source = makeNoise(91, 67, 2);
+        Framebuffer reference(160, 120);
+        UpscaleBilinear(source, reference);
+
+        ThreadPool pool(4);
+        LinearArena scratch;
+        for (int frame = 0; frame < 3; frame++) {
+            Framebuffer pooled(160, 120);
+            scratch.reset();
+            UpscaleBilinear(source, pooled, &pool, &scratch);
+            CHECK(samePixels(pooled, reference));
+            if (frame > 0) {
+                CHECK(scratch.stats().overflowBytes == 0);
+            }
+        }
+
+        // Downscaling goes through the same path
+        Framebuffer smaller(40, 30);
+        scratch.reset();
+        UpscaleBilinear(source, smaller, &pool, &scratch);
+        Framebuffer smallerReference(40, 30);
+        UpscaleBilinear(source, smallerReference);
+        CHECK(samePixels(smaller, smallerReference));
+    }
+}
+
+int main() {
+    checkIdentity();
+    checkEdgeClamp();
+    checkPoolAndScratch();
+    return TestFailures();
+}
@@ -0,0 +1,150 @@
+#include "math/vec3x8.h"
+#include "test_util.h"
+#include <cmath>
+#include <cstdint>
+
+namespace {
+    bool near(float a, float b, float tolerance = 1e-5f) {
+        return std::fabs(a - b) <= tolerance * (1.0f + std::fabs(b));
+    }
+
+    bool near(const vec3& a, const vec3& b, float tolerance = 1e-5f) {
+        return near(a.x, b.x, tolerance) && near(a.y, b.y, tolerance) && near(a.z, b.z, tolerance);
+    }
+
+    void randomVectors(vec3* out, int count, uint32_t seed) {
+        uint32_t state = seed;
+        auto next = [&state] {
+            state = state * 1664525u + 1013904223u;
+            return (float(state >> 8) / float(1 << 24) - 0.5f) * 20.0f;
+        };
+        for (int i = 0; i < count; i++) {
+            const float x = next(), y = next(), z = next();
+            out[i] = vec3(x, y, z);
+        }
+    }
+
+    void storeLanes(simd::float8 value, float* lanes) {
+        simd::store(lanes, value);
+    }
+
+    // Loads and stores keep lane i = vector i, in both layouts
+    void checkLoadStore() {
+        vec3 source[8];
+        randomVectors(source, 8, 1);
+        const vec3x8 packed = vec3x8::load(source);
+
+        vec3 roundTrip[8];
+        packed.store(roundTrip);
+        float xs[8], ys[8], zs[8];
+        packed.storeSoA(xs, ys, zs);
+        for (int i = 0; i < 8; i++) {
+            CHECK(roundTrip[i].x == source[i].x && roundTrip[i].y == source[i].y && roundTrip[i].z == source[i].z);
+            CHECK(xs[i] == source[i].x && ys[i] == source[i].y && zs[i] == source[i].z);
+        }
+
+        const vec3x8 fromSoA = vec3x8::loadSoA(xs, ys, zs);
+        fromSoA.store(roundTrip);
+        CHECK(roundTrip[5].x == source[5].x && roundTrip[7].z == source[7].z);
+
+        // Broadcast and default
+        vec3 lanes[8];
+        vec3x8(vec3(1, 2, 3)).store(lanes);
+        for (const vec3& lane : lanes) {
+            CHECK(lane.x == 1 && lane.y == 2 && lane.z == 3);
+        }
+        vec3x8().store(lanes);
+        CHECK(lanes[3].x == 0 && lanes[3].y == 0 && lanes[3].z == 0);
+    }
+
+    // Every operation matches the scalar vec3 version lane by lane
+    void checkMatchesScalar() {
+        vec3 a[8], b[8];
+        randomVectors(a, 8, 2);
+        randomVectors(b, 8, 3);
+        a[6] = vec3();   // Zero length lane
+        const vec3x8 va = vec3x8::load(a), vb = vec3x8::load(b);
+
+        vec3 sum[8], difference[8], scaled[8], laneScaled[8], cross[8], normalized[8];
+        (va + vb).store(sum);
+        (va - vb).store(difference);
+        (va * 2.5f).store(scaled);
+        const float factors[8] = { 1, -1, 0.5f, 2, 0, 3, -0.25f, 10 };
+        (va * simd::load(factors)).store(laneScaled);
+        va.cross(vb).store(cross);
+        va.normalized().store(normalized);
+
+        float dots[8], lengthsSquared[8], lengths[8];
+        storeLanes(va.dot(vb), dots);
+        storeLanes(va.lengthsquared(), lengthsSquared);
+        storeLanes(va.length(), lengths);
+
+        for (int i = 0; i < 8; i++) {
+            CHECK(near(sum[i], a[i] + b[i]));
+            CHECK(near(difference[i], a[i] - b[i]));
+            CHECK(near(scaled[i], a[i] * 2.5f));
+            CHECK(near(laneScaled[i], a[i] * factors[i]));
+            CHECK(near(cross[i], a[i].cross(b[i]), 1e-4f));
+            CHECK(near(dots[i], a[i].dot(b[i]), 1e-4f));
+            CHECK(near(lengthsSquared[i], a[i].lengthsquared()));
+            CHECK(near(lengths[i], a[i].length()));
+            // rsqrt + one Newton step: about 22 bits
+            CHECK(near(normalized[i], a[i].normalized(), 2e-6f));
+        }
+        CHECK(normalized[6].x == 0 && normalized[6].y == 0 && normalized[6].z == 0);
+    }
+
+    // transformPoint divides by w like mat4 * vec3; directions ignore translation
+    void checkTransforms() {
+        vec3 points[8];
+        randomVectors(points, 8, 4);
+        const vec3x8 packed = vec3x8::load(points);
+
+        const mat4 affine = mat4::translate(3, -1, 2) * mat4::rotate(0.9f, vec3(1, 2, 3).normalized()) *
+                            mat4::scale(1.5f, 0.5f, 2.0f);
+        const mat4 projection = mat4::perspective(1.2f, 1.0f, 0.1f, 100.0f) * mat4::translate(0, 0, -30);
+
+        vec3 transformed[8], projected[8], directions[8];
+        packed.transformPoint(affine).store(transformed);
+        packed.transformPoint(projection).store(projected);
+        packed.transformDirection(affine).store(directions);
+        for (int i = 0; i < 8; i++) {
+            CHECK(near(transformed[i], affine * points[i], 1e-5f));
+            CHECK(near(projected[i], projection * points[i], 1e-5f));
+            CHECK(near(directions[i], affine.transformDirection(points[i]), 1e-5f));
+        }
+    }
+
+    // Masks and selects used by the batch culling code
+    void checkMasks() {
+        const float a[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+        const float b[8] = { 7, 6, 5, 4, 3, 2, 1, 0 };
+        const simd::float8 va = simd::load(a), vb = simd::load(b);
+        CHECK(simd::movemask(simd::lessThan(va, vb)) == 0x0F);
+        CHECK(simd::movemask(simd::lessEqual(va, simd::set1(3))) == 0x0F);
+        CHECK(simd::movemask(simd::lessThan(va, vb) | simd::lessThan(vb, simd::set1(1))) == 0x8F);
+        CHECK(simd::movemask(simd::andNot(simd::lessThan(va, simd::set1(6)), simd::lessThan(va, simd::set1(2)))) == 0x3C);
+
+        float selected[8], smallest[8], largest[8];
+        storeLanes(simd::select(simd::lessThan(va, vb), va, vb), selected);
+        storeLanes(simd::min(va, vb), smallest);
+        storeLanes(simd::max(va, vb), largest);
+        for (int i = 0; i < 8; i++) {
+            CHECK(selected[i] == std::fmin(a[i], b[i]));
+            CHECK(smallest[i] == std::fmin(a[i], b[i]));
+            CHECK(largest[i] == std::fmax(a[i], b[i]));
+        }
+
+        float lanes[8];
+        storeLanes(simd::keepWherePositive(simd::set1(9), va - simd::set1(3)), lanes);
+        CHECK(lanes[3] == 0 && lanes[4] == 9 && lanes[0] == 0);
+    }
+}
+
+int main() {
+    checkLoadStore();
+    checkMatchesScalar();
+    checkTransforms();
+    checkMasks();
+    return TestFailures();
+}
@@ -0,0 +1,104 @@
+#include "math/mat4.h"
+#include "math/vec4.h"
+#include "test_util.h"
+#include <cmath>
+#include <cstdint>
+
+namespace {
+    bool near(float a, float b, float tolerance = 1e-5f) {
+        return std::fabs(a - b) <= tolerance * (1.0f + std::fabs(b));
+    }
+
+    bool near(const vec4& a, const vec4& b, float tolerance = 1e-5f) {
+        return near(a.x, b.x, tolerance) && near(a.y, b.y, tolerance) &&
+               near(a.z, b.z, tolerance) && near(a.w, b.w, tolerance);
+    }
+
+    bool equal(const vec4& a, float x, float y, float z, float w) {
+        return a.x == x && a.y == y && a.z == z && a.w == w;
+    }
+
+    void checkArithmetic() {
+        CHECK(alignof(vec4) == 16 && sizeof(vec4) == 16);
+        CHECK(equal(vec4(), 0, 0, 0, 0));
+        CHECK(equal(vec4(2.5f), 2.5f, 2.5f, 2.5f, 2.5f));
+        CHECK(equal(vec4(vec3(1, 2, 3), 4), 1, 2, 3, 4));
+
+        const vec4 a(1, -2, 3, 0.5f), b(4, 5, -6, 2);
+        CHECK(equal(a + b, 5, 3, -3, 2.5f));
+        CHECK(equal(a - b, -3, -7, 9, -1.5f));
+        CHECK(equal(a * b, 4, -10, -18, 1));
+        CHECK(equal(a * 2.0f, 2, -4, 6, 1));
+        CHECK(equal(2.0f * a, 2, -4, 6, 1));
+        CHECK(equal(a / 2.0f, 0.5f, -1, 1.5f, 0.25f));
+        CHECK(equal(-a, -1, 2, -3, -0.5f));
+
+        vec4 c = a;
+        c += b;
+        CHECK(equal(c, 5, 3, -3, 2.5f));
+        c -= b;
+        CHECK(equal(c, 1, -2, 3, 0.5f));
+        c *= 4.0f;
+        CHECK(equal(c, 4, -8, 12, 2));
+        c /= 4.0f;
+        CHECK(equal(c, 1, -2, 3, 0.5f));
+
+        // All four lanes take part in the horizontal sum
+        CHECK(a.dot(b) == 4 - 10 - 18 + 1);
+        CHECK(vec4(0, 0, 0, 3).dot(vec4(0, 0, 0, 5)) == 15);
+        CHECK(vec4(1, 2, 2, 4).lengthsquared() == 25);
+        CHECK(vec4(1, 2, 2, 4).length() == 5);
+
+        const vec3 xyz = a.xyz();
+        CHECK(xyz.x == 1 && xyz.y == -2 && xyz.z == 3);
+        const vec3 projected = vec4(2, 4, -6, 2).projected();
+        CHECK(projected.x == 1 && projected.y == 2 && projected.z == -3);
+    }
+
+    void checkNormalize() {
+        const vec4 v(3, -4, 12, 84);   // Length 85
+        const vec4 exact = v.normalized();
+        CHECK(near(exact, vec4(3.0f / 85, -4.0f / 85, 12.0f / 85, 84.0f / 85), 1e-6f));
+        CHECK(near(exact.length(), 1.0f, 1e-6f));
+        CHECK(equal(vec4().normalized(), 0, 0, 0, 0));
+
+        // rsqrt + one Newton step: about 22 bits
+        uint32_t state = 12345;
+        for (int i = 0; i < 200; i++) {
+            float lanes[4];
+            for (float& lane : lanes) {
+                state = state * 1664525u + 1013904223u;
+                lane = (float(state >> 8) / float(1 << 24) - 0.5f) * 200.0f;
+            }
+            const vec4 random(lanes[0], lanes[1], lanes[2], lanes[3]);
+            CHECK(near(random.normalizedFast(), random.normalized(), 2e-6f));
+        }
+        CHECK(equal(vec4().normalizedFast(), 0, 0, 0, 0));
+        CHECK(equal(vec4(std::nanf(""), 1, 1, 1).normalizedFast(), 0, 0, 0, 0));
+    }
+
+    // mat4 * vec4 is homogeneous: no divide, w carries through
+    void checkTransform() {
+        const mat4 m = mat4::translate(1, 2, 3) * mat4::rotateZ(0.7f) * mat4::scale(2.0f);
+        const vec3 p(0.5f, -1.5f, 4.0f);
+        const vec4 point = m * vec4(p, 1.0f);
+        const vec3 expected = m * p;
+        CHECK(near(point, vec4(expected, 1.0f)));
+
+        const vec4 direction = m * vec4(p, 0.0f);
+        CHECK(near(direction, vec4(m.transformDirection(p), 0.0f)));
+
+        const mat4 projection = mat4::perspective(1.0f, 1.5f, 0.1f, 100.0f);
+        const vec4 clip = projection * vec4(p.x, p.y, -p.z, 1.0f);
+        const vec3 ndc = projection * vec3(p.x, p.y, -p.z);
+        CHECK(clip.w != 1.0f);
+        CHECK(near(clip.projected().x, ndc.x) && near(clip.projected().y, ndc.y) && near(clip.projected().z, ndc.z));
+    }
+}
+
+int main() {
+    checkArithmetic();
+    checkNormalize();
+    checkTransform();
+    return TestFailures();
+}
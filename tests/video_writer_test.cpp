@@ -0,0 +1,184 @@
+#include "image/video_writer.h"
+#include "core/thread_pool.h"
+#include "test_util.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    struct Planes {
+        std::vector<uint8_t> y, u, v;
+
+        Planes(int width, int height)
+            : y(size_t(width) * height, 0xAA),
+              u(size_t((width + 1) / 2) * ((height + 1) / 2), 0xAA),
+              v(u.size(), 0xAA) {}
+
+        bool operator==(const Planes& other) const { return y == other.y && u == other.u && v == other.v; }
+    };
+
+    // Deterministic noise with a few saturated pixels mixed in
+    Framebuffer makeFrame(int width, int height, uint32_t seed) {
+        Framebuffer frame(width, height);
+        uint32_t state = seed * 2654435761u + 1;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                state = state * 1664525u + 1013904223u;
+                uint32_t pixel = state;
+                if ((state >> 28) == 0) pixel = 0xFFFFFFFF;
+                if ((state >> 28) == 1) pixel = 0xFF000000;
+                frame.setPixel(x, y, pixel);
+            }
+        }
+        return frame;
+    }
+
+    Planes convertScalar(const Framebuffer& frame) {
+        Planes planes(frame.getWidth(), frame.getHeight());
+        ConvertARGBToI420Scalar(frame.data(), frame.getWidth(), frame.getHeight(),
+                                planes.y.data(), planes.u.data(), planes.v.data(), 0, frame.getHeight());
+        return planes;
+    }
+
+    std::vector<uint8_t> readFile(const char* path) {
+        std::vector<uint8_t> bytes;
+        FILE* file = std::fopen(path, "rb");
+        if (!file) return bytes;
+        uint8_t buffer[4096];
+        size_t count;
+        while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            bytes.insert(bytes.end(), buffer, buffer + count);
+        }
+        std::fclose(file);
+        return bytes;
+    }
+
+    // The SIMD path matches the scalar one byte for byte: odd sizes, widths
+    // that aren't a multiple of 8 or 16, and conversion in even row strips
+    void checkMatchesScalar() {
+        const int sizes[][2] = { { 1, 1 }, { 2, 2 }, { 3, 5 }, { 7, 3 }, { 8, 8 }, { 9, 1 }, { 15, 9 },
+                                 { 16, 16 }, { 17, 13 }, { 24, 7 }, { 33, 31 }, { 100, 67 } };
+        for (const auto& size : sizes) {
+            const int width = size[0], height = size[1];
+            const Framebuffer frame = makeFrame(width, height, width * 131 + height);
+            const Planes reference = convertScalar(frame);
+
+            Planes whole(width, height);
+            ConvertARGBToI420(frame.data(), width, height, whole.y.data(), whole.u.data(), whole.v.data(), 0, height);
+            CHECK(whole == reference);
+
+            Planes strips(width, height);
+            for (int begin = 0; begin < height; begin += 4) {
+                const int end = begin + 4 < height ? begin + 4 : height;
+                ConvertARGBToI420(frame.data(), width, height, strips.y.data(), strips.u.data(), strips.v.data(),
+                                  begin, end);
+            }
+            CHECK(strips == reference);
+        }
+
+        // Flat colors: every chroma sample is the same, including the
+        // replicated last column and row
+        Framebuffer flat(5, 3);
+        flat.clear(0xFF3080C0);
+        const Planes planes = convertScalar(flat);
+        CHECK(planes.u.size() == 3 * 2);
+        for (size_t i = 0; i < planes.u.size(); i++) {
+            CHECK(planes.u[i] == planes.u[0] && planes.v[i] == planes.v[0]);
+        }
+        for (uint8_t luma : planes.y) {
+            CHECK(luma == planes.y[0]);
+        }
+
+        // Limited range: black and white map to 16 and 235, grey has no chroma
+        Framebuffer extremes(2, 2);
+        extremes.setPixel(0, 0, 0xFF000000);
+        extremes.setPixel(1, 0, 0xFFFFFFFF);
+        extremes.setPixel(0, 1, 0xFF808080);
+        extremes.setPixel(1, 1, 0xFF808080);
+        const Planes limited = convertScalar(extremes);
+        CHECK(limited.y[0] == 16 && limited.y[1] == 235);
+        CHECK(limited.u[0] == 128 && limited.v[0] == 128);
+    }
+
+    // A Y4M stream is the header, then per frame "FRAME\n" and the Y, U and V
+    // planes back to back; the pool splits rows into strips but not the output
+    void checkY4MLayout() {
+        const char* path = "video_writer_test.y4m";
+        const int width = 37, height = 70;   // Odd width, several 32-row strips
+        const Framebuffer frames[2] = { makeFrame(width, height, 1), makeFrame(width, height, 2) };
+
+        ThreadPool pool(3);
+        {
+            VideoWriter writer(path, width, height, VideoFormat::Y4M, 24, &pool);
+            CHECK(writer.isOpen());
+            CHECK(writer.writeFrame(frames[0]));
+            CHECK(writer.writeFrame(frames[1]));
+            CHECK(!writer.writeFrame(Framebuffer(width + 1, height)));  // Wrong size
+            CHECK(writer.close());
+            CHECK(writer.getFramesWritten() == 2);
+        }
+
+        const std::vector<uint8_t> bytes = readFile(path);
+        const std::string header = "YUV4MPEG2 W37 H70 F24:1 Ip A1:1 C420jpeg\n";
+        const size_t lumaBytes = size_t(width) * height;
+        const size_t chromaBytes = size_t(19) * 35;
+        const size_t frameBytes = 6 + lumaBytes + 2 * chromaBytes;
+        CHECK(bytes.size() == header.size() + 2 * frameBytes);
+        if (bytes.size() == header.size() + 2 * frameBytes) {
+            CHECK(std::memcmp(bytes.data(), header.data(), header.size()) == 0);
+            for (int i = 0; i < 2; i++) {
+                const uint8_t* frame = bytes.data() + header.size() + i * frameBytes;
+                const Planes expected = convertScalar(frames[i]);
+                CHECK(std::memcmp(frame, "FRAME\n", 6) == 0);
+                CHECK(std::memcmp(frame + 6, expected.y.data(), lumaBytes) == 0);
+                CHECK(std::memcmp(frame + 6 + lumaBytes, expected.u.data(), chromaBytes) == 0);
+                CHECK(std::memcmp(frame + 6 + lumaBytes + chromaBytes, expected.v.data(), chromaBytes) == 0);
+            }
+        }
+        std::remove(path);
+    }
+
+    // Raw frames are the framebuffer words, B G R A, with no header
+    void checkRawLayout() {
+        const char* path = "video_writer_test.bgra";
+        const Framebuffer frame = makeFrame(5, 3, 7);
+        {
+            VideoWriter writer(path, 5, 3, VideoFormat::RawBGRA);
+            CHECK(writer.writeFrame(frame));
+            CHECK(writer.close());
+        }
+        const std::vector<uint8_t> bytes = readFile(path);
+        CHECK(bytes.size() == 5 * 3 * 4);
+        if (bytes.size() == 5 * 3 * 4) {
+            const uint32_t pixel = frame.getPixel(1, 2);
+            const uint8_t* written = bytes.data() + (2 * 5 + 1) * 4;
+            CHECK(written[0] == getBlue(pixel) && written[1] == getGreen(pixel));
+            CHECK(written[2] == getRed(pixel) && written[3] == getAlpha(pixel));
+        }
+        std::remove(path);
+    }
+
+    // F0:1 is not a valid Y4M header: such a writer never opens its output
+    void checkRejectsZeroFps() {
+        const char* path = "video_writer_test_fps.y4m";
+        std::remove(path);
+        VideoWriter writer(path, 4, 4, VideoFormat::Y4M, 0);
+        CHECK(!writer.isOpen());
+        CHECK(!writer.writeFrame(Framebuffer(4, 4)));
+        CHECK(!writer.close());
+        CHECK(readFile(path).empty() && std::fopen(path, "rb") == nullptr);
+
+        VideoWriter negative(path, 4, 4, VideoFormat::Y4M, -30);
+        CHECK(!negative.isOpen());
+        std::remove(path);
+    }
+}
+
+int main() {
+    checkMatchesScalar();
+    checkY4MLayout();
+    checkRawLayout();
+    checkRejectsZeroFps();
+    return TestFailures();
+}